@@ -0,0 +1,423 @@
+#include "njson/njson.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+	Benchmarks for parsing, printing, lookups and destruction on synthetic
+	corpora modeled on common workloads. The corpora are generated with a
+	fixed seed, so runs (and releases) are comparable on the same machine.
+
+		bench [-r runs] [-s MB] [corpus ...]
+
+	Every operation runs `runs` times and the fastest run is reported,
+	allocations are counted through the global operator new.
+*/
+
+#ifndef NJSON_BENCH_BUILD_TYPE
+# define NJSON_BENCH_BUILD_TYPE ""
+#endif
+
+using namespace njson;
+
+/* -------------------------------------------------------------------------- */
+/*                                 Allocations                                */
+/* -------------------------------------------------------------------------- */
+
+static size_t	alloc_count = 0;
+static size_t	alloc_bytes = 0;
+
+static void*	allocate(size_t size) noexcept {
+	++alloc_count;
+	alloc_bytes += size;
+	return (std::malloc(size ? size : 1));
+}
+
+// not inlined: the compiler would see free() on memory that operator new returned and warn
+static __attribute__((noinline)) void	deallocate(void* p) noexcept {
+	std::free(p);
+}
+
+void*	operator new(size_t size) {
+	if (void* p = allocate(size))
+		return (p);
+	throw(std::bad_alloc());
+}
+
+void*	operator new[](size_t size) { return (operator new(size)); }
+void*	operator new(size_t size, std::nothrow_t const&) noexcept { return (allocate(size)); }
+void*	operator new[](size_t size, std::nothrow_t const&) noexcept { return (allocate(size)); }
+void	operator delete(void* p) noexcept { deallocate(p); }
+void	operator delete[](void* p) noexcept { deallocate(p); }
+void	operator delete(void* p, size_t) noexcept { deallocate(p); }
+void	operator delete[](void* p, size_t) noexcept { deallocate(p); }
+void	operator delete(void* p, std::nothrow_t const&) noexcept { deallocate(p); }
+void	operator delete[](void* p, std::nothrow_t const&) noexcept { deallocate(p); }
+
+/* -------------------------------------------------------------------------- */
+/*                                   Corpora                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// xorshift64*, the corpora only need to be the same every run
+class Random
+{
+	public:
+		Random() : state(0x9E3779B97F4A7C15ull) {}
+
+		uint64_t next(void) {
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return (state * 0x2545F4914F6CDD1Dull);
+		}
+
+		size_t below(size_t n) { return (size_t(next() % n)); }
+		double unit(void) { return (double(next() >> 11) / double(1ull << 53)); }
+
+	private:
+		uint64_t	state;
+};
+
+struct Corpus {
+	std::string					name;
+	std::vector<std::string>	documents;	// more than one for the many small documents
+
+	size_t bytes(void) const {
+		size_t	total = 0;
+		for (std::string const& doc : documents)
+			total += doc.size();
+		return (total);
+	}
+};
+
+static char const*	words[] = {
+	"the", "json", "parser", "arena", "fast", "value", "object", "array", "tree", "node",
+	"stream", "caf\\u00e9", "na\xc3\xafve", "\\\"quoted\\\"", "line\\nbreak", "emoji \\ud83d\\ude00",
+};
+
+static void	put_text(std::string& out, Random& rng, size_t count) {
+	out += '\"';
+	for (size_t i = 0; i < count; ++i) {
+		if (i > 0)
+			out += ' ';
+		out += words[rng.below(sizeof(words) / sizeof(*words))];
+	}
+	out += '\"';
+}
+
+static void	put_double(std::string& out, double d) {
+	char	buf[32];
+	std::snprintf(buf, sizeof(buf), "%.15g", d);
+	out += buf;
+}
+
+// records of a social media timeline: ids, text with escapes, nested user and entities
+static Corpus	make_tweets(size_t target) {
+	Random		rng;
+	std::string	out = "{\"statuses\":[";
+	for (size_t i = 0; out.size() < target; ++i) {
+		if (i > 0)
+			out += ',';
+		out += "{\"id\":" + std::to_string(505874924095815681ull + i * 7919);
+		out += ",\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"text\":";
+		put_text(out, rng, 8 + rng.below(16));
+		out += ",\"user\":{\"id\":" + std::to_string(rng.below(4000000000ull));
+		out += ",\"screen_name\":\"user" + std::to_string(rng.below(100000)) + '\"';
+		out += ",\"name\":";
+		put_text(out, rng, 2);
+		out += ",\"followers_count\":" + std::to_string(rng.below(100000));
+		out += ",\"verified\":";
+		out += rng.below(10) == 0 ? "true" : "false";
+		out += ",\"profile_image_url\":\"http://pbs.twimg.com/profile_images/" + std::to_string(rng.next() % 1000000000) + "/normal.jpeg\"}";
+		out += ",\"entities\":{\"hashtags\":[";
+		for (size_t h = rng.below(3); h > 0; --h) {
+			size_t	at = rng.below(120);
+			out += "{\"text\":\"tag" + std::to_string(rng.below(1000)) + "\",\"indices\":[" + std::to_string(at) + ',' + std::to_string(at + 7) + "]}";
+			if (h > 1)
+				out += ',';
+		}
+		out += "],\"urls\":[],\"user_mentions\":[]}";
+		out += ",\"retweet_count\":" + std::to_string(rng.below(1000));
+		out += ",\"favorite_count\":" + std::to_string(rng.below(1000));
+		out += ",\"favorited\":false,\"lang\":\"en\",\"coordinates\":null}";
+	}
+	out += "]}";
+	return (Corpus{"tweets", {out}});
+}
+
+// polygons of full precision coordinates, almost all of the input is floats
+static Corpus	make_geojson(size_t target) {
+	Random		rng;
+	std::string	out = "{\"type\":\"FeatureCollection\",\"features\":[";
+	for (size_t i = 0; out.size() < target; ++i) {
+		if (i > 0)
+			out += ',';
+		out += "{\"type\":\"Feature\",\"properties\":{\"name\":\"region " + std::to_string(i) + "\"},";
+		out += "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[";
+		double	lon = -140.0 + rng.unit() * 80.0;
+		double	lat = 42.0 + rng.unit() * 30.0;
+		for (size_t p = 0; p < 1000; ++p) {
+			lon += (rng.unit() - 0.5) * 0.01;
+			lat += (rng.unit() - 0.5) * 0.01;
+			out += p > 0 ? ",[" : "[";
+			put_double(out, lon);
+			out += ',';
+			put_double(out, lat);
+			out += ']';
+		}
+		out += "]]}}";
+	}
+	out += "]}";
+	return (Corpus{"geojson", {out}});
+}
+
+// chains of objects and arrays nested 256 levels deep
+static Corpus	make_deep(size_t target) {
+	std::string	out = "[";
+	for (size_t i = 0; out.size() < target; ++i) {
+		if (i > 0)
+			out += ',';
+		for (size_t level = 0; level < 128; ++level)
+			out += "{\"level\":" + std::to_string(level) + ",\"child\":[";
+		out += "{\"leaf\":true}";
+		for (size_t level = 0; level < 128; ++level)
+			out += "]}";
+	}
+	out += ']';
+	return (Corpus{"deep", {out}});
+}
+
+// a few long strings, mostly plain text with some escapes and multibyte characters
+static Corpus	make_strings(size_t target) {
+	Random		rng;
+	std::string	out = "[";
+	for (size_t i = 0; out.size() < target; ++i) {
+		if (i > 0)
+			out += ',';
+		put_text(out, rng, 1000 + rng.below(10000));
+	}
+	out += ']';
+	return (Corpus{"strings", {out}});
+}
+
+// many messages of ~150 bytes, each parsed on its own like requests of a service
+static Corpus	make_small(size_t target) {
+	Random		rng;
+	Corpus		corpus{"small", {}};
+	for (size_t total = 0; total < target; total += corpus.documents.back().size()) {
+		std::string	doc = "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(corpus.documents.size());
+		doc += ",\"method\":\"cache.get\",\"params\":{\"key\":\"session:" + std::to_string(rng.next() % 100000000) + '\"';
+		doc += ",\"ttl\":" + std::to_string(rng.below(3600)) + ",\"tags\":[\"web\",\"eu-west\"],\"refresh\":";
+		doc += rng.below(2) ? "true" : "false";
+		doc += ",\"score\":";
+		put_double(doc, rng.unit());
+		doc += "}}";
+		corpus.documents.push_back(doc);
+	}
+	return (corpus);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Measurement                                */
+/* -------------------------------------------------------------------------- */
+
+// a stream that only counts what is written to it
+class CountingBuffer : public std::streambuf
+{
+	public:
+		CountingBuffer() : written(0) {}
+
+		size_t	written;
+
+	protected:
+		int_type overflow(int_type c) { ++written; return (traits_type::not_eof(c)); }
+		std::streamsize xsputn(char const*, std::streamsize n) { written += n; return (n); }
+};
+
+struct Result {
+	double	seconds;
+	size_t	allocs;
+	size_t	alloc_bytes;
+};
+
+class Timer
+{
+	public:
+		void start(void) {
+			allocs = alloc_count;
+			bytes = alloc_bytes;
+			begin = std::chrono::steady_clock::now();
+		}
+
+		Result stop(void) {
+			std::chrono::duration<double>	elapsed = std::chrono::steady_clock::now() - begin;
+			return (Result{elapsed.count(), alloc_count - allocs, alloc_bytes - bytes});
+		}
+
+	private:
+		std::chrono::steady_clock::time_point	begin;
+		size_t									allocs;
+		size_t									bytes;
+};
+
+// the fastest of the runs, setup and teardown of every run aren't timed
+template <typename Setup, typename Run, typename Teardown>
+static Result	best_of(size_t runs, Setup setup, Run run, Teardown teardown) {
+	Result	best = {1e300, 0, 0};
+	for (size_t i = 0; i < runs; ++i) {
+		Timer	timer;
+		setup();
+		timer.start();
+		run();
+		Result	result = timer.stop();
+		teardown();
+		if (result.seconds < best.seconds)
+			best = result;
+	}
+	return (best);
+}
+
+static size_t	count_nodes(Json const& json) {
+	size_t	nodes = 1;
+	if (json.is<Json::array>()) {
+		for (Json const& element : json.get<Json::array>())
+			nodes += count_nodes(element);
+	} else if (json.is<Json::object>()) {
+		for (auto const& member : json.get<Json::object>())
+			nodes += count_nodes(member.second);
+	}
+	return (nodes);
+}
+
+struct Lookup {
+	Json*		object;
+	StringRef	key;
+};
+
+// every key of every object, and a key that isn't there
+static void	collect_lookups(Json& json, std::vector<Lookup>& lookups) {
+	if (json.is<Json::array>()) {
+		for (Json& element : json.get<Json::array>())
+			collect_lookups(element, lookups);
+	} else if (json.is<Json::object>()) {
+		for (auto& member : json.get<Json::object>()) {
+			lookups.push_back(Lookup{&json, StringRef(member.first.data(), member.first.size())});
+			collect_lookups(member.second, lookups);
+		}
+		lookups.push_back(Lookup{&json, StringRef("missing")});
+	}
+}
+
+static void	report(Corpus const& corpus, char const* op, Result const& result, size_t bytes, size_t items, char const* unit) {
+	char	mbs[32] = "-";
+	if (bytes > 0)
+		std::snprintf(mbs, sizeof(mbs), "%.1f", bytes / result.seconds / 1e6);
+	std::printf("%-8s %-14s %10s %10.1f %-7s %12zu %10.1f\n", corpus.name.c_str(), op, mbs,
+		result.seconds * 1e9 / double(items), unit, result.allocs, result.alloc_bytes / 1e6);
+}
+
+static void	bench(Corpus const& corpus, size_t runs) {
+	std::vector<Json::pointer_t>	roots;
+	auto	parse_all = [&]() {
+		for (std::string const& doc : corpus.documents) {
+			JsonParser	parser(doc.data(), doc.size());
+			roots.push_back(parser.parse());
+			if (parser.has_error()) {
+				std::cerr << corpus.name << ": " << parser.get_error_msg() << std::endl;
+				std::exit(1);
+			}
+		}
+	};
+	auto	nothing = []() {};
+	auto	clear = [&]() { roots.clear(); };
+
+	// parsing and destruction are measured on fresh documents every run
+	Result	parsed = best_of(runs, clear, parse_all, nothing);
+	Result	destroyed = best_of(runs, [&]() { roots.clear(); parse_all(); }, clear, nothing);
+	parse_all();
+
+	size_t	nodes = 0;
+	for (Json::pointer_t const& root : roots)
+		nodes += count_nodes(*root);
+
+	CountingBuffer	compact_buffer;
+	CountingBuffer	pretty_buffer;
+	std::ostream	compact(&compact_buffer);
+	std::ostream	pretty(&pretty_buffer);
+	Result	printed = best_of(runs, [&]() { compact_buffer.written = 0; }, [&]() {
+		for (Json::pointer_t const& root : roots)
+			root->print(compact, false);
+	}, nothing);
+	Result	printed_pretty = best_of(runs, [&]() { pretty_buffer.written = 0; }, [&]() {
+		for (Json::pointer_t const& root : roots)
+			root->print(pretty, true);
+	}, nothing);
+
+	std::vector<Lookup>	lookups;
+	size_t				found = 0;
+	for (Json::pointer_t& root : roots)
+		collect_lookups(*root, lookups);
+	Result	looked_up = best_of(runs, nothing, [&]() {
+		for (Lookup const& lookup : lookups)
+			found += bool(lookup.object->find(lookup.key));
+	}, nothing);
+	if (found > lookups.size() * runs)
+		std::abort();
+
+	size_t	bytes = corpus.bytes();
+	report(corpus, "parse", parsed, bytes, nodes, "ns/node");
+	report(corpus, "print compact", printed, compact_buffer.written, nodes, "ns/node");
+	report(corpus, "print pretty", printed_pretty, pretty_buffer.written, nodes, "ns/node");
+	report(corpus, "find", looked_up, 0, std::max<size_t>(lookups.size(), 1), "ns/find");
+	report(corpus, "destroy", destroyed, 0, nodes, "ns/node");
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                    Main                                    */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char** argv) {
+	size_t						runs = 5;
+	size_t						megabytes = 16;
+	std::vector<std::string>	selected;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string	arg = argv[i];
+		if ((arg == "-r" || arg == "-s") && i + 1 < argc) {
+			size_t	n = std::strtoul(argv[++i], nullptr, 10);
+			(arg == "-r" ? runs : megabytes) = std::max<size_t>(n, 1);
+		} else if (arg[0] == '-') {
+			std::cerr << "usage: " << argv[0] << " [-r runs] [-s MB] [tweets|geojson|deep|strings|small ...]" << std::endl;
+			return (1);
+		} else {
+			selected.push_back(arg);
+		}
+	}
+
+	typedef Corpus	(*Generator)(size_t);
+	std::vector<std::pair<char const*, Generator>>	generators = {
+		{"tweets", make_tweets}, {"geojson", make_geojson}, {"deep", make_deep},
+		{"strings", make_strings}, {"small", make_small},
+	};
+
+	std::string	build = NJSON_BENCH_BUILD_TYPE;
+	std::printf("njson bench, build %s, %zu runs, corpora of %zu MB\n", build.empty() ? "(none)" : build.c_str(), runs, megabytes);
+	std::printf("%-8s %-14s %10s %10s %-7s %12s %10s\n", "corpus", "op", "MB/s", "time", "", "allocs", "alloc MB");
+	for (auto const& generator : generators) {
+		if (!selected.empty() && std::find(selected.begin(), selected.end(), generator.first) == selected.end())
+			continue ;
+		bench(generator.second(megabytes << 20), runs);
+	}
+	return (0);
+}
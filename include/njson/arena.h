@@ -0,0 +1,140 @@
+#ifndef NJSON_ARENA_H
+# define NJSON_ARENA_H
+
+# include <atomic>
+# include <cstddef>
+# include <memory>
+# include <mutex>
+# include <new>
+# include <type_traits>
+# include <vector>
+
+# include "njson/stats.h"
+
+namespace njson {
+
+/*
+	Monotonic allocator for the nodes and containers of one document.
+	Memory is handed out from a few large blocks and never given back
+	individually, deallocating is a no-op. The arena counts the nodes,
+	containers, keys and string views that use it and frees all of its
+	blocks at once when the last one is destroyed, so subtrees can
+	safely outlive their root.
+
+	The parser allocates without locking while it builds the document.
+	Once it hands the document over it calls share(), and from then on
+	allocations take a lock: the containers of one document can grow from
+	different threads, like containers on the heap.
+*/
+class Arena
+{
+	public:
+		Arena();
+
+		// the first block is about first_block bytes (within limits), for documents known to be small
+		explicit Arena(size_t first_block);
+
+		Arena(Arena const& other) = delete;
+		Arena& operator=(Arena const& other) = delete;
+
+	public:
+		void*	allocate(size_t size, size_t align);
+
+		// allocations lock from now on, called before the document leaves the thread that built it
+		void	share(void) { shared = true; }
+
+		// reference counting, release() deletes the arena when the count drops to zero
+		void	retain(void) { refs.fetch_add(1, std::memory_order_relaxed); }
+		void	release(void) {
+			if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				delete this;
+		}
+
+		// total bytes reserved in blocks
+		size_t	capacity(void) const { return reserved; }
+
+		// keeps owner alive as long as the arena, for input that values of the document point into
+		void	keep_alive(std::shared_ptr<void const> owner) { owners.push_back(std::move(owner)); }
+
+	private:
+		~Arena();
+
+		struct Block {
+			Block*	next;
+			size_t	size;
+		};
+
+		void*	allocate_unlocked(size_t size, size_t align);
+		void*	allocate_block(size_t size, size_t align);
+
+		Block*					blocks;
+		char*					cur;
+		char*					end;
+		size_t					next_size;
+		size_t					reserved;
+		std::atomic<size_t>		refs;
+		bool					shared;
+		std::mutex				mutex;
+
+		std::vector<std::shared_ptr<void const>>	owners;
+};
+
+/*
+	Standard allocator on top of an Arena, used by the Json containers.
+	A default constructed allocator has no arena and uses the heap, so
+	containers that aren't part of a parsed document behave as usual.
+
+	The allocator stays with its container: a Json node holds a reference
+	to the arena of its container, so assigning a container of another
+	arena (or the heap) moves the elements over one by one instead of
+	taking over the other allocator. Swapping containers of different
+	allocators isn't supported, std::swap() moves them instead.
+*/
+template <typename T>
+class ArenaAllocator
+{
+	public:
+		using value_type = T;
+
+		using propagate_on_container_copy_assignment = std::false_type;
+		using propagate_on_container_move_assignment = std::false_type;
+		using propagate_on_container_swap = std::false_type;
+
+		ArenaAllocator() noexcept : arena(nullptr) {}
+		explicit ArenaAllocator(Arena* arena) noexcept : arena(arena) {}
+
+		template <typename U>
+		ArenaAllocator(ArenaAllocator<U> const& other) noexcept : arena(other.get_arena()) {}
+
+		T*	allocate(size_t n) {
+			if (arena == nullptr) {
+				NJSON_STAT(stats_allocation(n * sizeof(T)));
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void	deallocate(T* p, size_t) noexcept {
+			if (arena == nullptr)
+				::operator delete(p);
+		}
+
+		Arena*	get_arena(void) const { return arena; }
+
+	private:
+		Arena*	arena;
+};
+
+template <typename T, typename U>
+bool operator==(ArenaAllocator<T> const& lhs, ArenaAllocator<U> const& rhs) {
+	return (lhs.get_arena() == rhs.get_arena());
+}
+
+template <typename T, typename U>
+bool operator!=(ArenaAllocator<T> const& lhs, ArenaAllocator<U> const& rhs) {
+	return (lhs.get_arena() != rhs.get_arena());
+}
+
+} // namespace njson
+
+#endif // NJSON_ARENA_H
@@ -0,0 +1,663 @@
+#ifndef NJSON_BIND_H
+# define NJSON_BIND_H
+
+# include <cstddef>
+# include <cstring>
+# include <limits>
+# include <map>
+# include <string>
+# include <type_traits>
+# include <vector>
+
+# include "njson/njson.h"
+# include "njson/number.h"
+# include "njson/sax.h"
+# include "njson/string_ref.h"
+# include "njson/writer.h"
+
+/*
+	Binding of C++ structs to JSON objects, to parse a document straight
+	into the types that use it and to serialize them back, without Json
+	nodes in between:
+
+		struct Endpoint { std::string host; int port; };
+		struct Config { std::string name; std::vector<Endpoint> endpoints; bool debug; };
+
+		NJSON_BIND(Endpoint, host, port)
+		NJSON_BIND(Config, name, endpoints, debug)
+
+		Config			config;
+		JsonParser		parser("config.json");
+		if (!parser.parse_into(config))
+			std::cerr << parser.get_error_msg() << std::endl;
+		std::string		json = to_json(config);
+
+	NJSON_BIND goes in the namespace of the struct (after it), with up to
+	64 public members that are named as their JSON keys. It generates a
+	table of the fields at compile time: their names and lengths and a
+	reader and writer for the type of every member. Keys are matched
+	against the table starting after the field that matched last, so
+	objects that list their keys in declaration order take one compare
+	per key.
+
+	Members can be bool, integers, floating point numbers, std::string,
+	other bound structs, and std::vector and std::map<std::string, T>
+	of those. Keys that aren't fields are skipped, missing fields and
+	null values keep the value the member had, and a key that comes twice
+	keeps its first value like parse(). Values of the wrong type and
+	integers that don't fit their member are errors.
+*/
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Fields                                   */
+/* -------------------------------------------------------------------------- */
+
+// a member of a bound struct T
+template <typename T>
+struct BoundField {
+	char const*	name;
+	size_t		size;
+	bool		(*read)(JsonParser& parser, T& value, char c, size_t depth);
+	void		(*write)(std::string& out, T const& value);
+};
+
+// the fields of a bound struct T, which NJSON_BIND generates
+template <typename T>
+struct BoundFields {
+	BoundField<T> const*	fields;
+	size_t					count;
+};
+
+// types declared with NJSON_BIND, their njson_bound_fields() is found through ADL
+template <typename T>
+class is_bound
+{
+	private:
+		template <typename U>
+		static std::true_type	test(decltype(njson_bound_fields(static_cast<U const*>(nullptr)))*);
+		template <typename U>
+		static std::false_type	test(...);
+
+	public:
+		static const bool	value = decltype(test<T>(nullptr))::value;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Reading                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+	The parser side of the bindings: reading scalars, walking objects and
+	arrays and skipping values, with the same checks and error messages
+	as parse(). Every read gets the first character of the value in c
+	with the parser just past it, like the parsing core, and the nesting
+	depth of the value.
+*/
+class JsonBinder
+{
+	public:
+		// a value that doesn't fit the member: null keeps the member as it is, anything else is an error
+		static bool mismatch(JsonParser& parser, char c, char const* expected) {
+			if (c == 'n') {
+				--parser.cur;
+				char	word = parser.scan_word();
+				if (word == 'n')
+					return (true);
+				if (word == 0)
+					return (false);
+			}
+			return (parser.set_error(std::string("expected ") + expected));
+		}
+
+		// true, false or null (false is returned through value)
+		static bool read_bool(JsonParser& parser, char c, bool& value) {
+			if (c != 't' && c != 'f')
+				return (mismatch(parser, c, "a bool"));
+			--parser.cur;
+			switch (parser.scan_word()) {
+				case 't' : value = true; return (true);
+				case 'f' : value = false; return (true);
+				case 'n' : return (true);
+				default : return (false);
+			}
+		}
+
+		// a number, false with the parser in error if it isn't one. Sets found if it is (null isn't)
+		static bool read_number(JsonParser& parser, char c, Json::number_int& _int, Json::number_float& _float,
+			bool& is_float, bool& found, char const* expected) {
+			found = false;
+			if (c != '-' && (c < '0' || c > '9'))
+				return (mismatch(parser, c, expected));
+			--parser.cur;
+			found = true;
+			return (parser.scan_number(_int, _float, is_float));
+		}
+
+		// an unsigned integer, including the ones past the int64_t range that scan as floats
+		static bool read_unsigned(JsonParser& parser, char c, uint64_t& value, bool& found) {
+			char const*			start = parser.cur - 1;
+			Json::number_int	_int;
+			Json::number_float	_float;
+			bool				is_float;
+			if (!read_number(parser, c, _int, _float, is_float, found, "an integer"))
+				return (false);
+			if (!found)
+				return (true);
+			if (!is_float) {
+				if (_int < 0)
+					return (parser.set_error("integer out of range: " + std::to_string(_int)));
+				value = uint64_t(_int);
+				return (true);
+			}
+			// the digits again, floats have a sign, a fraction or an exponent
+			value = 0;
+			for (char const* p = start; p < parser.cur; ++p) {
+				if (*p < '0' || *p > '9')
+					return (parser.set_error("expected an integer"));
+				if (value > (std::numeric_limits<uint64_t>::max() - uint64_t(*p - '0')) / 10)
+					return (parser.set_error("integer out of range: " + std::string(start, parser.cur)));
+				value = value * 10 + uint64_t(*p - '0');
+			}
+			return (true);
+		}
+
+		// a string, sets found if it is one (null isn't). str is valid until the next read
+		static bool read_string(JsonParser& parser, char c, StringRef& str, bool& found) {
+			found = false;
+			if (c != '\"')
+				return (mismatch(parser, c, "a string"));
+			found = true;
+			return (parser.scan_string_ref(str));
+		}
+
+		// any value, for keys that aren't bound
+		static bool skip(JsonParser& parser, char c) {
+			JsonHandler	ignore;
+			return (parser.parse_value(ignore, c));
+		}
+
+		static bool error(JsonParser& parser, std::string const& msg) {
+			return (parser.set_error(msg));
+		}
+
+		// an error inside the value of a member at depth, puts the member in front of the message
+		// (only the outermost levels, a document that is too deep would get a path that is just as deep)
+		static bool in_member(JsonParser& parser, StringRef name, size_t depth) {
+			if (depth < max_path)
+				parser.errmsg = name.str() + ": " + parser.errmsg;
+			else if (depth == max_path)
+				parser.errmsg = "...: " + parser.errmsg;
+			return (false);
+		}
+
+		/*
+			An object, member(key, c) is called for every member with c the
+			first character of the value. The key is only valid until the
+			value is read. Null is no object and no error.
+		*/
+		template <typename Member>
+		static bool read_object(JsonParser& parser, char c, size_t depth, Member const& member) {
+			if (c != '{')
+				return (mismatch(parser, c, "an object"));
+			if (!enter(parser, depth))
+				return (false);
+			parser.skip_ws();
+			if (parser.cur < parser.end && *parser.cur == '}') {
+				++parser.cur;
+				return (true);
+			}
+			while (true) {
+				StringRef	key;
+				if (!read_key(parser, key))
+					return (false);
+				if (!member(key, *parser.cur++))
+					return (false);
+				switch (next(parser, '}')) {
+					case MORE : break ;
+					case CLOSED : return (true);
+					default : return (false);
+				}
+			}
+		}
+
+		// an array, element(c) is called for every element. Null is no array and no error
+		template <typename Element>
+		static bool read_array(JsonParser& parser, char c, size_t depth, Element const& element) {
+			if (c != '[')
+				return (mismatch(parser, c, "an array"));
+			if (!enter(parser, depth))
+				return (false);
+			parser.skip_ws();
+			if (parser.cur < parser.end && *parser.cur == ']') {
+				++parser.cur;
+				return (true);
+			}
+			while (true) {
+				if (parser.cur == parser.end)
+					return (parser.set_error("array not closed by ']'"));
+				if (!element(*parser.cur++))
+					return (false);
+				switch (next(parser, ']')) {
+					case MORE : break ;
+					case CLOSED : return (true);
+					default : return (false);
+				}
+			}
+		}
+
+	private:
+		enum Next { FAILED, MORE, CLOSED };
+
+		static const size_t	max_path = 16;
+
+		static bool enter(JsonParser& parser, size_t depth) {
+			if (depth < parser.max_depth)
+				return (true);
+			return (parser.set_error("document too deep, nested more than " + std::to_string(parser.max_depth) + " levels"));
+		}
+
+		// the key and ':' of the next member, the parser is left at the first character of the value
+		static bool read_key(JsonParser& parser, StringRef& key) {
+			if (parser.cur == parser.end)
+				return (parser.set_error("object not closed by '}'"));
+			if (*parser.cur != '\"') {
+				if (JsonParser::is_delimiter(*parser.cur))
+					return (parser.set_error(std::string{"bad object, unexpected token: '"} + *parser.cur + '\''));
+				return (parser.set_error("bad object, key not encapsulated by quotes"));
+			}
+			++parser.cur;
+			if (!parser.scan_string_ref(key))
+				return (false);
+			parser.skip_ws();
+			if (parser.cur == parser.end || *parser.cur != ':')
+				return (parser.set_error("bad object, key not followed by ':'"));
+			++parser.cur;
+			parser.skip_ws();
+			if (parser.cur == parser.end)
+				return (parser.set_error("object not closed by '}'"));
+			return (true);
+		}
+
+		// after a value of a container: ',' and the start of the next one, or the closing bracket
+		static Next next(JsonParser& parser, char close) {
+			parser.skip_ws();
+			if (parser.cur == parser.end) {
+				parser.set_error(close == '}' ? "object not closed by '}'" : "array not closed by ']'");
+				return (FAILED);
+			}
+			if (*parser.cur == close) {
+				++parser.cur;
+				return (CLOSED);
+			}
+			if (*parser.cur != ',') {
+				parser.set_error(close == '}' ? "bad object, elements not seperated by ','" : "bad array, elements not seperated by ','");
+				return (FAILED);
+			}
+			++parser.cur;
+			parser.skip_ws();
+			return (MORE);
+		}
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  Bindings                                  */
+/* -------------------------------------------------------------------------- */
+
+// JsonBinding<T> reads (with JsonBinder) and writes values of type T
+template <typename T, typename Enable>
+struct JsonBinding {
+	static_assert(sizeof(T) == 0, "njson: the type can't be bound, declare it with NJSON_BIND");
+};
+
+template <>
+struct JsonBinding<bool> {
+	static bool read(JsonParser& parser, bool& value, char c, size_t) {
+		return (JsonBinder::read_bool(parser, c, value));
+	}
+
+	static void write(std::string& out, bool value) {
+		if (value)
+			out.append("true", 4);
+		else
+			out.append("false", 5);
+	}
+};
+
+// integers have to fit the member
+template <typename T>
+struct JsonBinding<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+	static bool read(JsonParser& parser, T& value, char c, size_t) {
+		Json::number_int	_int;
+		Json::number_float	_float;
+		bool				is_float;
+		bool				found;
+		if (!JsonBinder::read_number(parser, c, _int, _float, is_float, found, "an integer"))
+			return (false);
+		if (!found)
+			return (true);
+		if (is_float)
+			return (JsonBinder::error(parser, "expected an integer"));
+		if (_int < int64_t(std::numeric_limits<T>::min()) || _int > int64_t(std::numeric_limits<T>::max()))
+			return (JsonBinder::error(parser, "integer out of range: " + std::to_string(_int)));
+		value = T(_int);
+		return (true);
+	}
+
+	static void write(std::string& out, T value) {
+		char	buf[number_buffer_size];
+		out.append(buf, format_int(buf, int64_t(value)) - buf);
+	}
+};
+
+// unsigned members read back every value they write, past the int64_t range too
+template <typename T>
+struct JsonBinding<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+	&& !std::is_same<T, bool>::value>::type> {
+	static bool read(JsonParser& parser, T& value, char c, size_t) {
+		uint64_t	_uint = 0;
+		bool		found;
+		if (!JsonBinder::read_unsigned(parser, c, _uint, found))
+			return (false);
+		if (!found)
+			return (true);
+		if (_uint > uint64_t(std::numeric_limits<T>::max()))
+			return (JsonBinder::error(parser, "integer out of range: " + std::to_string(_uint)));
+		value = T(_uint);
+		return (true);
+	}
+
+	static void write(std::string& out, T value) {
+		// past the int64_t range, which format_int() doesn't cover
+		if (uint64_t(value) > uint64_t(std::numeric_limits<int64_t>::max())) {
+			out.append(std::to_string(uint64_t(value)));
+			return ;
+		}
+		char	buf[number_buffer_size];
+		out.append(buf, format_int(buf, int64_t(value)) - buf);
+	}
+};
+
+// floating point members take integers as well
+template <typename T>
+struct JsonBinding<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+	static bool read(JsonParser& parser, T& value, char c, size_t) {
+		Json::number_int	_int;
+		Json::number_float	_float;
+		bool				is_float;
+		bool				found;
+		if (!JsonBinder::read_number(parser, c, _int, _float, is_float, found, "a number"))
+			return (false);
+		if (!found)
+			return (true);
+		value = T(is_float ? _float : Json::number_float(_int));
+		return (true);
+	}
+
+	static void write(std::string& out, T value) {
+		char	buf[number_buffer_size];
+		out.append(buf, format(buf, value) - buf);
+	}
+
+	private:
+		// floats with the digits of the float, not of the double it converts to
+		static char* format(char* buf, float value) { return (format_float(buf, value)); }
+		static char* format(char* buf, double value) { return (format_double(buf, value)); }
+		static char* format(char* buf, long double value) { return (format_double(buf, double(value))); }
+};
+
+template <>
+struct JsonBinding<std::string> {
+	static bool read(JsonParser& parser, std::string& value, char c, size_t) {
+		StringRef	str;
+		bool		found;
+		if (!JsonBinder::read_string(parser, c, str, found))
+			return (false);
+		if (found)
+			value.assign(str.data(), str.size());
+		return (true);
+	}
+
+	static void write(std::string& out, std::string const& value) {
+		JsonWriter::append_string(out, value.data(), value.size());
+	}
+};
+
+// the elements replace the contents of the vector
+template <typename T, typename Allocator>
+struct JsonBinding<std::vector<T, Allocator>> {
+	static bool read(JsonParser& parser, std::vector<T, Allocator>& value, char c, size_t depth) {
+		if (c == '[')
+			value.clear();
+		return (JsonBinder::read_array(parser, c, depth, [&](char e) {
+			value.emplace_back();
+			return (read_element(parser, value.back(), e, depth + 1));
+		}));
+	}
+
+	static void write(std::string& out, std::vector<T, Allocator> const& value) {
+		out.push_back('[');
+		for (size_t i = 0; i < value.size(); ++i) {
+			if (i > 0)
+				out.push_back(',');
+			JsonBinding<T>::write(out, value[i]);
+		}
+		out.push_back(']');
+	}
+
+	private:
+		static bool read_element(JsonParser& parser, T& element, char c, size_t depth) {
+			return (JsonBinding<T>::read(parser, element, c, depth));
+		}
+
+		// elements of std::vector<bool> aren't addressable
+		template <typename Reference>
+		static bool read_element(JsonParser& parser, Reference element, char c, size_t depth) {
+			T	copy = element;
+			if (!JsonBinding<T>::read(parser, copy, c, depth))
+				return (false);
+			element = copy;
+			return (true);
+		}
+};
+
+// the members replace the contents of the map, a key that comes twice keeps its first value like parse()
+template <typename T, typename Compare, typename Allocator>
+struct JsonBinding<std::map<std::string, T, Compare, Allocator>> {
+	static bool read(JsonParser& parser, std::map<std::string, T, Compare, Allocator>& value, char c, size_t depth) {
+		if (c == '{')
+			value.clear();
+		return (JsonBinder::read_object(parser, c, depth, [&](StringRef key, char m) {
+			// (the key may point into the parser's buffer, which the value overwrites)
+			auto	inserted = value.insert(std::make_pair(key.str(), T()));
+			if (!inserted.second)
+				return (JsonBinder::skip(parser, m));
+			return (JsonBinding<T>::read(parser, inserted.first->second, m, depth + 1)
+				|| JsonBinder::in_member(parser, StringRef(inserted.first->first), depth));
+		}));
+	}
+
+	static void write(std::string& out, std::map<std::string, T, Compare, Allocator> const& value) {
+		out.push_back('{');
+		for (auto it = value.begin(); it != value.end(); ++it) {
+			if (it != value.begin())
+				out.push_back(',');
+			JsonWriter::append_string(out, it->first.data(), it->first.size());
+			out.push_back(':');
+			JsonBinding<T>::write(out, it->second);
+		}
+		out.push_back('}');
+	}
+};
+
+// structs declared with NJSON_BIND, a field that comes twice keeps its first value like parse()
+template <typename T>
+struct JsonBinding<T, typename std::enable_if<is_bound<T>::value>::type> {
+	static bool read(JsonParser& parser, T& value, char c, size_t depth) {
+		BoundFields<T>	bound = njson_bound_fields(static_cast<T const*>(nullptr));
+		size_t			expected = 0;	// keys usually come in the order of the fields
+		uint64_t		seen = 0;		// a bit per field read (there are at most 64)
+		return (JsonBinder::read_object(parser, c, depth, [&](StringRef key, char m) {
+			for (size_t n = 0, i = expected; n < bound.count; ++n, ++i) {
+				if (i == bound.count)
+					i = 0;
+				BoundField<T> const&	field = bound.fields[i];
+				if (field.size == key.size() && std::memcmp(field.name, key.data(), field.size) == 0) {
+					expected = i + 1;
+					if (seen & (uint64_t(1) << i))
+						return (JsonBinder::skip(parser, m));
+					seen |= uint64_t(1) << i;
+					return (field.read(parser, value, m, depth + 1)
+						|| JsonBinder::in_member(parser, StringRef(field.name, field.size), depth));
+				}
+			}
+			return (JsonBinder::skip(parser, m));
+		}));
+	}
+
+	static void write(std::string& out, T const& value) {
+		BoundFields<T>	bound = njson_bound_fields(static_cast<T const*>(nullptr));
+		out.push_back('{');
+		for (size_t i = 0; i < bound.count; ++i) {
+			if (i > 0)
+				out.push_back(',');
+			// member names don't need escaping
+			out.push_back('\"');
+			out.append(bound.fields[i].name, bound.fields[i].size);
+			out.append("\":", 2);
+			bound.fields[i].write(out, value);
+		}
+		out.push_back('}');
+	}
+};
+
+// what NJSON_BIND puts in the field table for the member of T
+template <typename T, typename M, M T::*Member>
+bool	read_bound_field(JsonParser& parser, T& value, char c, size_t depth) {
+	return (JsonBinding<M>::read(parser, value.*Member, c, depth));
+}
+
+template <typename T, typename M, M T::*Member>
+void	write_bound_field(std::string& out, T const& value) {
+	JsonBinding<M>::write(out, value.*Member);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Entry                                   */
+/* -------------------------------------------------------------------------- */
+
+// an empty input binds nothing, like it has no events
+template <typename T>
+bool JsonParser::parse_into(T& value) {
+	if (!start_input())
+		return (false);
+	if (cur == end)
+		return (true);
+	return (JsonBinding<T>::read(*this, value, *cur++, 0) && end_document());
+}
+
+// appends the compact JSON of value to out
+template <typename T>
+void	to_json(std::string& out, T const& value) {
+	JsonBinding<T>::write(out, value);
+}
+
+template <typename T>
+std::string	to_json(T const& value) {
+	std::string	out;
+	JsonBinding<T>::write(out, value);
+	return (out);
+}
+
+} // namespace njson
+
+/* -------------------------------------------------------------------------- */
+/*                                   Macros                                   */
+/* -------------------------------------------------------------------------- */
+
+// declares the fields of Type, in the namespace of Type
+# define NJSON_BIND(Type, ...) \
+	inline ::njson::BoundFields<Type>	njson_bound_fields(Type const*) { \
+		static const ::njson::BoundField<Type>	fields[] = { \
+			NJSON_BIND_FIELDS_(Type, NJSON_BIND_COUNT_(__VA_ARGS__), __VA_ARGS__) \
+		}; \
+		return (::njson::BoundFields<Type>{fields, sizeof(fields) / sizeof(*fields)}); \
+	}
+
+# define NJSON_BIND_FIELD_(Type, f) \
+	{#f, sizeof(#f) - 1, &::njson::read_bound_field<Type, decltype(Type::f), &Type::f>, \
+		&::njson::write_bound_field<Type, decltype(Type::f), &Type::f>},
+
+// NJSON_BIND_FIELDS_(Type, N, f1, ..., fN) expands NJSON_BIND_FIELD_ for every field
+# define NJSON_BIND_EXPAND_(x) x
+# define NJSON_BIND_NTH_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, N, ...) N
+# define NJSON_BIND_COUNT_(...) NJSON_BIND_EXPAND_(NJSON_BIND_NTH_(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+# define NJSON_BIND_CAT_(a, b) a ## b
+# define NJSON_BIND_FIELDS_(Type, N, ...) NJSON_BIND_EXPAND_(NJSON_BIND_CAT_(NJSON_BIND_FIELDS_, N)(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_1(Type, f) NJSON_BIND_FIELD_(Type, f)
+# define NJSON_BIND_FIELDS_2(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_1(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_3(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_2(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_4(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_3(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_5(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_4(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_6(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_5(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_7(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_6(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_8(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_7(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_9(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_8(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_10(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_9(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_11(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_10(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_12(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_11(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_13(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_12(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_14(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_13(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_15(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_14(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_16(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_15(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_17(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_16(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_18(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_17(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_19(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_18(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_20(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_19(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_21(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_20(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_22(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_21(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_23(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_22(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_24(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_23(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_25(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_24(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_26(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_25(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_27(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_26(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_28(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_27(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_29(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_28(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_30(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_29(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_31(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_30(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_32(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_31(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_33(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_32(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_34(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_33(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_35(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_34(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_36(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_35(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_37(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_36(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_38(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_37(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_39(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_38(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_40(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_39(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_41(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_40(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_42(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_41(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_43(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_42(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_44(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_43(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_45(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_44(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_46(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_45(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_47(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_46(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_48(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_47(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_49(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_48(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_50(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_49(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_51(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_50(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_52(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_51(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_53(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_52(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_54(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_53(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_55(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_54(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_56(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_55(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_57(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_56(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_58(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_57(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_59(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_58(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_60(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_59(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_61(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_60(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_62(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_61(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_63(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_62(Type, __VA_ARGS__))
+# define NJSON_BIND_FIELDS_64(Type, f, ...) NJSON_BIND_FIELD_(Type, f) NJSON_BIND_EXPAND_(NJSON_BIND_FIELDS_63(Type, __VA_ARGS__))
+
+#endif // NJSON_BIND_H
@@ -0,0 +1,105 @@
+#ifndef NJSON_JSON_LINES_H
+# define NJSON_JSON_LINES_H
+
+# include <cstddef>
+# include <functional>
+# include <iostream>
+# include <memory>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+
+namespace njson {
+
+/*
+	Reader for newline-delimited JSON (JSON Lines / NDJSON): one document
+	per line, blank lines are skipped. The input is cut into batches of
+	whole lines that a pool of worker threads parses in parallel, the
+	records are handed to the callback on the calling thread.
+
+	Ordered reading delivers the records in input order. Unordered
+	reading delivers every batch as soon as it's parsed, which keeps all
+	workers busy when the records differ a lot in size. The number of
+	parsed batches waiting to be delivered is bounded, so a slow callback
+	holds the workers back instead of filling the memory.
+*/
+class JsonLinesReader
+{
+	public:
+		struct Record {
+			size_t			line;	// line number in the input, starting at 1
+			Json::pointer_t	json;	// null_ptr if the line isn't valid json
+			std::string		error;	// the parse error, empty for valid lines
+		};
+
+		// receives every record, returns false to stop reading
+		using callback_t = std::function<bool(Record& record)>;
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		// files are memory-mapped when possible, streams are read completely first
+		JsonLinesReader(std::string const& path);
+		JsonLinesReader(std::istream& stream);
+
+		// the buffer is not copied, it has to outlive read()
+		JsonLinesReader(char const* data, size_t length);
+
+		JsonLinesReader(JsonLinesReader const& other) = delete;
+		JsonLinesReader& operator=(JsonLinesReader const& other) = delete;
+
+		~JsonLinesReader() {}
+
+// ========================== METHODS ========================== //
+	public:
+		// parses all records, returns the number of records delivered
+		size_t read(callback_t const& callback);
+
+		bool has_error() const { return error; }
+		std::string const& get_error_msg(void) const { return errmsg; }
+
+		// number of worker threads, 0 uses one per hardware thread (default: 0).
+		// With 1 the records are parsed on the calling thread
+		void set_threads(size_t n) { threads = n; }
+		size_t get_threads(void) const { return threads; }
+
+		// deliver the records in input order (default: true)
+		void set_ordered(bool use) { ordered = use; }
+		bool get_ordered(void) const { return ordered; }
+
+		// approximate size in bytes of the batches handed to the workers (default: 256 KB)
+		void set_batch_size(size_t size) { batch_size = size > 0 ? size : 1; }
+		size_t get_batch_size(void) const { return batch_size; }
+
+		// parser options used for every record (see JsonParser)
+		void set_use_arena(bool use) { use_arena = use; }
+		void set_intern_keys(bool use) { intern_keys = use; }
+		void set_key_schema(std::shared_ptr<KeySchema const> schema) { key_schema = std::move(schema); }
+
+// ========================== PRIVATE ========================== //
+	private:
+		struct Batch;
+		class Pool;
+
+		void cut_batches(std::vector<Batch>& batches) const;
+		void parse_batch(Batch& batch, JsonParser& parser) const;
+
+		bool							error;
+		std::string						errmsg;
+
+		std::shared_ptr<MappedFile>		mapping;
+		std::string						buffer; // stream input
+		char const*						data;
+		size_t							length;
+
+		size_t							threads;
+		bool							ordered;
+		size_t							batch_size;
+		bool							use_arena;
+		bool							intern_keys;
+		std::shared_ptr<KeySchema const>	key_schema;
+};
+
+} // namespace njson
+
+#endif // NJSON_JSON_LINES_H
@@ -0,0 +1,261 @@
+#ifndef NJSON_KEY_H
+# define NJSON_KEY_H
+
+# include <atomic>
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <initializer_list>
+# include <ostream>
+# include <string>
+# include <vector>
+
+# include "njson/arena.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Immutable object key. A Key is a single pointer to a shared
+	representation that holds the length, a precomputed hash and the
+	characters, so copying a key never copies the characters.
+
+	Keys either live on the heap (reference counted) or in the arena of
+	a document, in which case every copy keeps the arena alive. Keys
+	interned by a KeyPool are unique within their pool, so two interned
+	keys of the same document are equal only if they are the same key.
+*/
+class Key
+{
+	private:
+		struct Rep {
+			Arena*					arena;	// null for heap keys
+			std::atomic<uint32_t>	refs;	// only counted for heap keys
+			uint32_t				size;
+			uint32_t				hash;
+			bool					interned;
+
+			char*	chars(void) { return reinterpret_cast<char*>(this + 1); }
+		};
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		Key() : rep(nullptr) {}
+		Key(char const* str) : rep(make_rep(str, std::strlen(str), nullptr)) {}
+		Key(std::string const& str) : rep(make_rep(str.data(), str.size(), nullptr)) {}
+		explicit Key(StringRef str) : rep(make_rep(str.data(), str.size(), nullptr)) {}
+
+		// the key is stored in the arena (a null arena means the heap)
+		Key(StringRef str, Arena* arena) : rep(make_rep(str.data(), str.size(), arena)) {}
+
+		Key(Key const& other) : rep(other.rep) { retain(); }
+		Key(Key&& other) noexcept : rep(other.rep) { other.rep = nullptr; }
+
+		Key& operator=(Key const& other) { Key(other).swap(*this); return (*this); }
+		Key& operator=(Key&& other) noexcept { Key(std::move(other)).swap(*this); return (*this); }
+
+		~Key() { release(); }
+
+// ========================== METHODS ========================== //
+	public:
+		char const* data(void) const { return rep ? rep->chars() : ""; }
+		size_t size(void) const { return rep ? rep->size : 0; }
+		bool empty(void) const { return size() == 0; }
+
+		uint32_t hash(void) const { return rep ? rep->hash : hash(nullptr, 0); }
+		bool is_interned(void) const { return rep && rep->interned; }
+
+		// the arena the key is stored in, null for heap keys
+		Arena* get_arena(void) const { return rep ? rep->arena : nullptr; }
+
+		std::string str(void) const { return std::string(data(), size()); }
+		StringRef ref(void) const { return StringRef(data(), size()); }
+		operator StringRef() const { return ref(); }
+
+		void swap(Key& other) noexcept { Rep* tmp = rep; rep = other.rep; other.rep = tmp; }
+
+		// hash used for all keys (32-bit FNV-1a)
+		static uint32_t hash(char const* data, size_t size);
+
+		int compare(Key const& other) const {
+			if (rep == other.rep)
+				return (0);
+			return (ref().compare(other.ref()));
+		}
+
+		friend bool operator==(Key const& lhs, Key const& rhs) {
+			if (lhs.rep == rhs.rep)
+				return (true);
+			if (lhs.hash() != rhs.hash())
+				return (false);
+			// interned keys of one document are unique
+			if (lhs.is_interned() && rhs.is_interned() && lhs.rep->arena == rhs.rep->arena)
+				return (false);
+			return (lhs.ref() == rhs.ref());
+		}
+		friend bool operator!=(Key const& lhs, Key const& rhs) { return !(lhs == rhs); }
+		friend bool operator<(Key const& lhs, Key const& rhs) { return lhs.compare(rhs) < 0; }
+
+		friend std::ostream& operator<<(std::ostream& out, Key const& key) {
+			return (out.write(key.data(), key.size()));
+		}
+
+// ========================== PRIVATE ========================== //
+	private:
+		friend class KeyPool;
+
+		// takes over the reference to rep
+		explicit Key(Rep* rep) : rep(rep) {}
+
+		static Rep* make_rep(char const* str, size_t len, Arena* arena);
+
+		void retain(void) {
+			if (rep == nullptr)
+				return ;
+			if (rep->arena != nullptr)
+				rep->arena->retain();
+			else
+				rep->refs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void release(void) {
+			if (rep == nullptr)
+				return ;
+			if (rep->arena != nullptr)
+				rep->arena->release();
+			else if (rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				::operator delete(rep);
+		}
+
+		Rep*	rep;
+};
+
+/*
+	Interns the keys of one document. Every distinct key is stored once
+	in the arena, every later occurrence shares that storage. Without an
+	arena the pool allocates one of its own for the keys.
+*/
+class KeyPool
+{
+	public:
+		KeyPool() : arena(nullptr), count(0) {}
+
+		KeyPool(KeyPool const& other) = delete;
+		KeyPool& operator=(KeyPool const& other) = delete;
+
+		~KeyPool() { reset(nullptr); }
+
+	public:
+		// forgets all keys and starts a new pool storing its keys in arena, keys handed out stay valid
+		void reset(Arena* arena);
+
+		Key intern(char const* str, size_t len);
+
+		// number of distinct keys
+		size_t size(void) const { return count; }
+
+	private:
+		void grow(void);
+
+		Arena*					arena;
+		std::vector<Key::Rep*>	slots;
+		size_t					count;
+};
+
+
+/*
+	The keys that documents of a known shape use, registered once (for
+	example the fields of a message type) and shared by every parse with
+	JsonParser::set_key_schema(). Every key has a fixed slot, its number
+	in the schema. A perfect hash is generated for the set when it's
+	built, so a key of the input is recognized with one probe and one
+	compare, without hashing it byte by byte. The parser puts the shared
+	Key of the schema in the document, so recognized keys aren't copied
+	or interned, and members with a schema key are told apart by slot.
+
+	The hash samples the first and last 8 bytes and the length of a key,
+	keys that can't be told apart that way are hashed completely. Meant
+	for the dozens of keys of a message type: in a set of hundreds the
+	generator may fail to separate some keys, those then simply aren't
+	recognized and take the generic path like keys outside the schema.
+*/
+class KeySchema
+{
+	public:
+		// the slot of a key that isn't in the schema
+		static const size_t	npos = size_t(-1);
+
+		// duplicate keys are registered once
+		KeySchema(std::initializer_list<StringRef> keys);
+		explicit KeySchema(std::vector<std::string> const& keys);
+
+		KeySchema(KeySchema const& other) = delete;
+		KeySchema& operator=(KeySchema const& other) = delete;
+
+	public:
+		// the slot of the key, npos if it isn't in the schema
+		size_t find(StringRef key) const {
+			Entry const&	entry = table[(fingerprint(key.data(), key.size()) * multiplier) >> shift];
+			if (entry.size == key.size() && std::memcmp(entry.chars, key.data(), key.size()) == 0)
+				return (entry.slot);
+			return (npos);
+		}
+
+		Key const& key(size_t slot) const { return keys[slot]; }
+
+		// number of keys (and slots)
+		size_t size(void) const { return keys.size(); }
+
+	private:
+		// a slot of the hash table, empty ones have a size no key has
+		struct Entry {
+			char const*	chars;
+			uint32_t	size;
+			uint32_t	slot;
+		};
+
+		void add(StringRef key);
+		void build(void);
+		size_t place(size_t bits);
+
+		// what the hash is computed from: the length, the first and the last 8 bytes (which identifies
+		// keys of up to 16 bytes), with whole_keys also the words before those
+		uint64_t fingerprint(char const* str, size_t len) const {
+			uint64_t	mixed = uint64_t(len) << 56;
+			uint64_t	head = 0;
+			uint64_t	tail = 0;
+			if (whole_keys) {
+				for (; len > 16; str += 8, len -= 8) {
+					std::memcpy(&head, str, 8);
+					mixed = (mixed ^ head) * 0x9E3779B97F4A7C15ull;
+					mixed ^= mixed >> 29;
+				}
+				head = 0;
+			}
+			if (len >= 8) {
+				std::memcpy(&head, str, 8);
+				std::memcpy(&tail, str + len - 8, 8);
+			} else if (len >= 4) {
+				uint32_t	first, last;
+				std::memcpy(&first, str, 4);
+				std::memcpy(&last, str + len - 4, 4);
+				head = first;
+				tail = last;
+			} else if (len > 0) {
+				head = uint64_t(static_cast<unsigned char>(str[0]))
+					| uint64_t(static_cast<unsigned char>(str[len / 2])) << 8
+					| uint64_t(static_cast<unsigned char>(str[len - 1])) << 16;
+			}
+			return (mixed ^ head ^ (tail * 0xC2B2AE3D27D4EB4Full));
+		}
+
+		std::vector<Key>	keys;
+		std::vector<Entry>	table;
+		uint64_t			multiplier;	// odd, the hash is (fingerprint * multiplier) >> shift
+		unsigned			shift;
+		bool				whole_keys;
+};
+
+} // namespace njson
+
+#endif // NJSON_KEY_H
@@ -0,0 +1,40 @@
+#ifndef NJSON_MAPPED_FILE_H
+# define NJSON_MAPPED_FILE_H
+
+# include <cstddef>
+# include <string>
+
+namespace njson {
+
+/*
+	Read-only memory mapping of a whole file. The pages are mapped with
+	a sequential access hint, so the kernel can read ahead while parsing.
+	On platforms without mmap (or for files that can't be mapped, like
+	pipes) is_open() returns false and the caller should fall back to
+	reading the file through a stream.
+*/
+class MappedFile
+{
+	public:
+		MappedFile(std::string const& path);
+
+		MappedFile(MappedFile const& other) = delete;
+		MappedFile& operator=(MappedFile const& other) = delete;
+
+		~MappedFile();
+
+	public:
+		bool is_open(void) const { return open; }
+
+		char const* data(void) const { return addr; }
+		size_t size(void) const { return length; }
+
+	private:
+		char const*	addr;
+		size_t		length;
+		bool		open;
+};
+
+} // namespace njson
+
+#endif // NJSON_MAPPED_FILE_H
@@ -2,20 +2,38 @@
 # define NJSON_H
 
 # include <cstddef>
+# include <cstring>
 # include <fstream>
 # include <iostream>
 # include <memory>
-# include <map>
 # include <vector>
 
+# include "njson/arena.h"
+# include "njson/key.h"
+# include "njson/mapped_file.h"
+# include "njson/object_map.h"
+# include "njson/stats.h"
+# include "njson/string_ref.h"
+
 namespace njson {
 
+class JsonTape;
+class JsonOnDemand;
+class JsonWriter;
+class JsonBinder;
+template <typename T, typename Enable = void> struct JsonBinding;
+
 /*
 	In essence the Json class just holds it's type and value,
 	with value being an union. The complexity comes from the
 	array and object not being trivial data types, requiring
 	you to construct and instance of the Json class with the
 	type predetermined.
+
+	Json is a movable value type: arrays and objects hold their
+	children inline, without a node allocation per child. Whole
+	documents are handed out as pointer_t, and operator-> lets
+	code written for children being pointers keep using ->.
 */
 class Json
 {
@@ -30,14 +48,19 @@ class Json
 
 // =========================== TYPES =========================== //
 	public:
-		// pointer type, in this unique pointers are used. This is the return type of many functions
+		// pointer type, in this unique pointers are used. This is the type of parsed documents
 		using pointer_t = std::unique_ptr<Json>;
 
-		using key_t = std::string;
+		// object keys, parsed documents share one copy of every distinct key (see njson/key.h)
+		using key_t = Key;
+
+		// containers allocate from the document's arena, or from the heap by default
+		template <typename T>
+		using allocator = ArenaAllocator<T>;
 
 		// JSON types that can for example be used as template arguments in the public functions
-		using array = std::vector<pointer_t>;
-		using object = std::map<key_t, pointer_t>;
+		using array = std::vector<Json, allocator<Json>>;
+		using object = ObjectMap<Json>;
 		using string = std::string;
 		using number_float = double;
 		using number_int = int64_t;
@@ -60,11 +83,20 @@ class Json
 // =========================== UNION =========================== //
 	private:
 		// The value union is how the Json class handles it's internal data
+		// string value that points into the parsed input or, decoded, into the arena (see JsonParser::set_use_string_views)
+		struct StringView {
+			char const*	data;
+			size_t		size;
+			Arena*		arena; // keeps the input alive
+		};
+
 		union Value {
 			Value();
 			Value(array&& _array);
 			Value(object&& _object);
 			Value(string const& _str);
+			Value(string&& _str);
+			Value(StringView _view);
 			Value(number_float n);
 			Value(number_int n);
 			Value(bool b);
@@ -74,6 +106,7 @@ class Json
 			array as_array;
 			object as_object;
 			string as_string;
+			StringView as_view;
 			number_float as_float;
 			number_int as_int;
 			bool as_bool;
@@ -87,25 +120,51 @@ class Json
 		explicit Json(array&& array);
 		explicit Json(object&& object);
 		Json(string const& str);
+		Json(string&& str);
 		Json(const char* str);
 
 		template <
 			typename INTEGRAL,
 			typename std::enable_if<std::is_integral<INTEGRAL>::value>::type* = nullptr>
-		Json(INTEGRAL i) : type(Type::NUMBER_INT) , value(number_int(i)) {}
+		Json(INTEGRAL i) : type(Type::NUMBER_INT), is_view(false), value(number_int(i)) {}
 
 		template <
 			typename FLOATING,
 			typename std::enable_if<std::is_floating_point<FLOATING>::value>::type* = nullptr>
-		Json(FLOATING f) : type(Type::NUMBER_FLOAT) , value(number_float(f)) {}
+		Json(FLOATING f) : type(Type::NUMBER_FLOAT), is_view(false), value(number_float(f)) {}
 
 		Json(bool b);
 
 		Json(Json const& other) = delete; // delete copy constuctor
 		Json& operator=(Json const& other) = delete; // delete copy-assignment
 
-		// Destructor
-		~Json();
+		// moving leaves a null-type node behind. Inline for numbers, bools and string views,
+		// which are moved as plain bytes
+		Json(Json&& other) noexcept : type(other.type), is_view(other.is_view) {
+			if (owns_value())
+				move_value(other);
+			else
+				std::memcpy(static_cast<void*>(&value), &other.value, sizeof(value));
+			other.type = Type::NULL_T;
+			other.is_view = false;
+		}
+		Json& operator=(Json&& other) noexcept;
+
+		// Destructor, only the values that own something have work to do
+		~Json() {
+			if (type == Type::ARRAY || type == Type::OBJECT || type == Type::STRING)
+				release_value();
+		}
+
+		// deep copy on the heap, independent of the document (and arena) this node is part of
+		Json clone(void) const;
+
+		// Nodes are allocated on the heap with plain new, or inside an arena with new (arena) Json(...).
+		// Both kinds are released through the same delete, so pointer_t works for either.
+		static void* operator new(size_t size) { return (operator new(size, nullptr)); }
+		static void* operator new(size_t size, Arena* arena);
+		static void operator delete(void* p);
+		static void operator delete(void* p, Arena*) { operator delete(p); }
 
 // ========================== GETTERS ========================== //
 	public:
@@ -116,7 +175,8 @@ class Json
 			throw(json_exception("unsupported type"));
 		}
 
-		// CONST variant of get<T>() method
+		// CONST variant of get<T>() method. A const string that points into the input (string views)
+		// isn't turned into a std::string, get<std::string>() THROWs: read it with get_string() or get_string_ref()
 		template<typename T> T const& get(void) const {
 			throw(json_exception("unsupported type"));
 		}
@@ -129,15 +189,25 @@ class Json
 		// returns the enum-type of this Json node
 		Type get_type() const { return type; }
 
+		// the characters of a string node, without copying them when the string points into the input.
+		// THROWs if the node isn't a string
+		StringRef get_string_ref(void) const;
+
+		// a copy of the string of a string node, string views included. THROWs if the node isn't a string
+		std::string get_string(void) const { return (get_string_ref().str()); }
+
 		static std::string get_type_string(Type type);
 
 		std::string get_type_string(void) const { return get_type_string(this->get_type()); }
 
 		// these functions can be used to add key-value pairs to a Json object
+		// the value is moved into the object, nodes passed by pointer are deleted
+		void add_to_object(const key_t& key, Json&& json);
 		void add_to_object(const key_t& key, Json* json);
 		void add_to_object(const key_t& key, pointer_t json);
 
 		// these functions can be used to add values to a Json array
+		void add_to_array(Json&& json);
 		void add_to_array(Json* json);
 		void add_to_array(pointer_t json);
 
@@ -147,7 +217,7 @@ class Json
 			if (get_type() != Type::OBJECT) {
 				throw json_exception("Can't insert key-value pair, not an object!");
 			}
-			this->value.as_object.insert({key, pointer_t(new Json(_value))});
+			this->value.as_object.emplace(key, Json(_value));
 		}
 
 		// Array insert
@@ -156,43 +226,67 @@ class Json
 			if (get_type() != Type::ARRAY) {
 				throw json_exception("Can't insert value, not an array!");
 			}
-			this->value.as_array.push_back(pointer_t(new Json(_value)));
+			this->value.as_array.emplace_back(_value);
 		}
 
 // ============================ FIND =========================== //
 	public:
 		// find() method to get the value out of an object based on provided key
-		// if the key isn't found, it returns a null-type json node
-		pointer_t& find(key_t const& key);
+		// if the key isn't found, it returns a null-type json node: null_ref() for a const node,
+		// missing_ref() otherwise
+		Json& find(StringRef key);
+		Json const& find(StringRef key) const;
 
 		//	Find method for chain-finding in nested objects
 		template<typename... Args>
-		pointer_t& find(key_t const& first, Args... keys) {
-			return (find(first)->find(keys...));
+		Json& find(StringRef first, Args const&... keys) {
+			return (find(first).find(keys...));
+		}
+
+		template<typename... Args>
+		Json const& find(StringRef first, Args const&... keys) const {
+			return (find(first).find(keys...));
 		}
 
 		//	print the entire json-tree from this node (pretty = true also puts indentation and newlines)
 		void print(std::ostream& out = std::cout, bool pretty = true) const;
 
+		//	serialize the entire json-tree from this node into a string (see njson/writer.h)
+		std::string to_string(bool pretty = true) const;
+
+		//	compact binary snapshot of the entire json-tree from this node, read back with JsonParser::load_binary()
+		void save_binary(std::ostream& out) const;
+		std::string to_binary(void) const;
+
 		//	Allocation of a null-node pointer
 		static pointer_t null_ptr(void) { return pointer_t {new Json()}; };
 
-		//	Reference to a static null-node pointer
-		static pointer_t& null_ref(void) { static pointer_t null_p = null_ptr(); return null_p; };
+		//	Reference to an immutable null-node, shared by all threads
+		static Json const& null_ref(void) { static Json const null_node; return null_node; };
+
+		//	Reference to a null-node of the calling thread, reset to null on every call, so writing
+		//	through a lookup that found nothing changes nothing anyone else sees
+		static Json& missing_ref(void);
 
 // =================== OPERATOR OVERLOADS ====================== //
 	public:
 		// returns true if the type isn't a null-type (so if there's data to get or not)
 		operator bool() const { return type != Type::NULL_T; }
 
+		// children used to be pointer_t, so node->find("key")->get<T>() and *child keep working
+		Json* operator->() { return this; }
+		Json const* operator->() const { return this; }
+		Json& operator*() { return *this; }
+		Json const& operator*() const { return *this; }
+
 		// just calls print on the stream (only difference is that print() actually flushes)
 		friend std::ostream& operator<<(std::ostream& stream, Json const& rhs) {
-			rhs.print_impl(0, stream, true);
+			rhs.print_impl(stream, true);
 			return (stream);
 		}
 
 		friend std::ostream& operator<<(std::ostream& stream, pointer_t const& rhs) {
-			rhs->print_impl(0, stream, true);
+			rhs->print_impl(stream, true);
 			return (stream);
 		}
 
@@ -201,15 +295,34 @@ class Json
 		// Check type THROWs when the type of the node doesn't match the template arg type
 		template<typename T> void check_type(void) const {}
 
-		//	Destruction of array and object types
-		void	destroy_array();
-		void	destroy_object();
+		//	Arrays, objects and owned strings, they can't be moved as plain bytes
+		bool	owns_value(void) const {
+			return (type == Type::ARRAY || type == Type::OBJECT || (type == Type::STRING && !is_view));
+		}
+
+		//	Moves an owned value out of other, other still has to be destroyed
+		void	move_value(Json& other);
+
+		//	Destroys the value and releases the arena it keeps alive
+		void	release_value(void);
+
+		//	Destroys the value, without releasing the arena it keeps alive
+		void	destroy_value(void);
+
+		//	Arrays and objects of a document and string views keep the document's arena alive
+		Arena*	value_arena(void) const;
 
-		//	Printing
-		void	print_impl(size_t depth, std::ostream& out, bool pretty) const;
-		void	print_object(size_t depth, std::ostream& out, bool pretty) const;
-		void	print_array(size_t depth, std::ostream& out, bool pretty) const;
-		void	print_depth(size_t depth, std::ostream& out) const;
+		//	String values pointing into the input are only created by the parser
+		explicit Json(StringView view);
+		friend class JsonParser;
+
+		//	Turns a string view into an owned string, get<string>() only returns owned strings
+		void	own_string(void);
+
+		//	Printing, through a JsonWriter that flushes into the stream
+		void	print_impl(std::ostream& out, bool pretty) const;
+
+		friend class JsonWriter;
 
 // ======================== EXCEPTIONS ========================= //
 	public:
@@ -230,9 +343,43 @@ class Json
 // ======================== MEMBER VARS ======================== //
 	private:
 		Type	type;
+		bool	is_view; // the string value is as_view instead of as_string
 		Value	value;
 };
 
+/*
+	The specializations are defined in Json.cpp, they have to be declared
+	here so other translation units don't instantiate the primary templates.
+*/
+template<> void Json::check_type<Json::array>(void) const;
+template<> void Json::check_type<Json::object>(void) const;
+template<> void Json::check_type<Json::string>(void) const;
+template<> void Json::check_type<Json::number_float>(void) const;
+template<> void Json::check_type<Json::number_int>(void) const;
+template<> void Json::check_type<bool>(void) const;
+
+template<> Json::array& Json::get<Json::array>(void);
+template<> Json::object& Json::get<Json::object>(void);
+template<> Json::string& Json::get<Json::string>(void);
+template<> Json::number_float& Json::get<Json::number_float>(void);
+template<> Json::number_int& Json::get<Json::number_int>(void);
+template<> bool& Json::get<bool>(void);
+
+template<> Json::array const& Json::get<Json::array>(void) const;
+template<> Json::object const& Json::get<Json::object>(void) const;
+template<> Json::string const& Json::get<Json::string>(void) const;
+template<> Json::number_float const& Json::get<Json::number_float>(void) const;
+template<> Json::number_int const& Json::get<Json::number_int>(void) const;
+template<> bool const& Json::get<bool>(void) const;
+
+template<> bool Json::is<Json::null_t>(void) const;
+template<> bool Json::is<Json::array>(void) const;
+template<> bool Json::is<Json::object>(void) const;
+template<> bool Json::is<Json::string>(void) const;
+template<> bool Json::is<Json::number_float>(void) const;
+template<> bool Json::is<Json::number_int>(void) const;
+template<> bool Json::is<bool>(void) const;
+
 /*
 
 
@@ -243,33 +390,145 @@ class JsonParser
 	// ======================== CONSTRUCTOR ======================== //
 	public:
 		JsonParser();
+
+		// files are memory-mapped when possible, otherwise they're read through a stream
 		JsonParser(std::string const& path);
 		JsonParser(char const* path);
 		JsonParser(std::istream& stream);
 
+		// parse directly from a contiguous buffer, the buffer is not copied
+		// so it has to outlive the parse() call
+		JsonParser(char const* data, size_t length);
+
 		JsonParser(JsonParser const& other) = delete;
 		JsonParser& operator=(JsonParser const& other) = delete;
 
-		~JsonParser() {}
+		~JsonParser();
 	
 	// ========================== METHODS ========================== //
 	public:
 		void open(std::string const& path);
 		void close(void);
 
+		// continue with another buffer (not copied), the options are kept and the error is cleared
+		void open(char const* data, size_t length);
+
 		std::istream& get_stream(void) { return stream; }
 
+		// the mapping of the file being parsed (null if the input isn't a mapped file)
+		std::shared_ptr<MappedFile> const& get_mapping(void) const { return mapping; }
+
 		bool has_error() const { return error; }
 		std::string const& get_error_msg(void) const { return errmsg; }
 
+		// statistics of the last parse() (see njson/stats.h), all zero unless njson is built with NJSON_STATS
+		ParseStats const& get_stats(void) const { return stats; }
+
+		// large inputs are first indexed with a SIMD pass that locates every token (default: true)
+		void set_use_index(bool use) { use_index = use; }
+		bool get_use_index(void) const { return use_index; }
+
+		// parsed documents allocate their nodes from one arena (default: true)
+		// the arena is freed when the last value of the document is destroyed
+		void set_use_arena(bool use) { use_arena = use; }
+		bool get_use_arena(void) const { return use_arena; }
+
+		// documents nested deeper than this are rejected (default: 1024)
+		// parsing, writing and destroying a tree don't recurse, but clone() does, so keep it bounded
+		void set_max_depth(size_t depth) { max_depth = depth; }
+		size_t get_max_depth(void) const { return max_depth; }
+
+		// equal object keys of a document share one interned copy (default: true)
+		void set_intern_keys(bool use) { intern_keys = use; }
+		bool get_intern_keys(void) const { return intern_keys; }
+
+		// keys of the schema are recognized with its perfect hash and the document shares the keys
+		// of the schema, other keys are handled as usual (default: none, see KeySchema)
+		void set_key_schema(std::shared_ptr<KeySchema const> schema) { key_schema = std::move(schema); }
+		std::shared_ptr<KeySchema const> const& get_key_schema(void) const { return key_schema; }
+
+		// string values point into the input instead of being copied, strings with escapes are
+		// decoded while parsing (default: false, needs the arena).
+		// The document keeps mapped files and stream input alive, a buffer passed to
+		// JsonParser(data, length) has to outlive the document
+		void set_use_string_views(bool use) { use_string_views = use; }
+		bool get_use_string_views(void) const { return use_string_views; }
+
+		// a document that is one large top-level array can be parsed on several threads: the
+		// structural index splits it into ranges of elements that are parsed concurrently and
+		// joined in order. Needs the index, errors are reported as without threads
+		// (default: 1, 0 uses every hardware thread)
+		void set_threads(size_t n) { threads = n; }
+		size_t get_threads(void) const { return threads; }
+
 		Json::pointer_t parse(void);
 
+		// parse into the flat, read-only tape representation (include "njson/tape.h")
+		JsonTape parse_tape(void);
+
+		// parse straight into a struct declared with NJSON_BIND, without building Json nodes
+		// (include "njson/bind.h"). Returns false on an error
+		template <typename T>
+		bool parse_into(T& value);
+
+		// a document that is only parsed as far as lookups go, takes the rest of the input
+		// (include "njson/on_demand.h")
+		JsonOnDemand parse_on_demand(void);
+
+		// reads a binary snapshot written by Json::save_binary() instead of JSON text, with the same
+		// options (arena, interned keys, string views then point into the snapshot)
+		Json::pointer_t load_binary(void);
+
+		// parse without building a document, the handler gets an event for every value
+		// returns false on an error or when the handler stops (include "njson/sax.h")
+		template <typename Handler>
+		bool parse(Handler& handler);
+
+		// incremental parsing: the document is fed in chunks as they arrive, split anywhere
+		// (also inside strings and numbers). The chunks are not kept, only a partial token is.
+		// feed() returns false once the input is invalid, finish() ends the input and returns
+		// the document (null_ptr on an error). Afterwards the next document can be fed
+		bool feed(char const* data, size_t size);
+		bool feed(std::string const& data) { return feed(data.data(), data.size()); }
+		Json::pointer_t finish(void);
+
 	// ========================== MEMBERS ========================== //
 	private:
 		std::ifstream holder;
 		std::istream& stream;
 		bool error;
 		std::string errmsg;
+
+		// input is always parsed from [cur, end), stream input is slurped into buffer first.
+		// Documents with string views share the buffer
+		bool from_stream;
+		std::shared_ptr<MappedFile> mapping;
+		std::shared_ptr<std::string> buffer;
+		char const* cur;
+		char const* end;
+
+		bool use_arena;
+		Arena* arena; // arena of the document being parsed, only set during parse()
+		size_t threads;
+		size_t max_depth;
+		ParseStats stats;
+
+		bool intern_keys;
+		bool use_string_views;
+		KeyPool keys; // keys of the document being parsed, only used during parse()
+		std::shared_ptr<KeySchema const> key_schema;
+		std::string string_buffer; // strings with escapes are decoded into it
+
+		// structural index: offsets (from index_base) of every token start in the input
+		bool use_index;
+		std::vector<uint32_t> index;
+		char const* index_base;
+		uint32_t const* next_token; // null when parsing without index
+		uint32_t const* last_token;
+
+		// state of the document being fed, kept between feed() calls
+		class PushState;
+		std::unique_ptr<PushState> push;
 	
 	// ========================== PARSING ========================== //
 	private:
@@ -282,14 +541,66 @@ class JsonParser
 			WORD
 		};
 
-		Json::pointer_t set_error(std::string const& str);
+		static bool is_delimiter(char c);
+		static bool is_space(char c);
+
+		bool read_stream(void);
+		void reset_index(void);
+		void prepare_index(void);
+		void skip_ws(void);
+		char const* token_end(void) const;
+		bool scan_string_view(StringRef& str, bool& escaped);
+		bool scan_string_ref(StringRef& str);
+		bool scan_number(Json::number_int& _int, Json::number_float& _float, bool& is_float);
+		char scan_word(void);
+
+		bool set_error(std::string const& str);
+		bool stopped(void);
 		State get_state_from_c(char c);
-		Json::pointer_t run_state(State state);
-		Json::pointer_t state_object(void);
-		Json::pointer_t state_array(void);
-		Json::pointer_t state_string(void);
-		Json::pointer_t state_number(void);
-		Json::pointer_t state_word(void);
+
+		// reads the input and moves to the first token, false on an error
+		bool start_input(void);
+		// after the top-level value, false (an error) if anything but whitespace follows
+		bool end_document(void);
+		Arena* new_arena(size_t size) const;
+
+		// load_binary() of the snapshot at cur into root
+		bool read_snapshot(Json& root);
+
+		// parse() of a top-level array on several threads, null if the input isn't one (or invalid)
+		Json::pointer_t parse_parallel(void);
+		bool parse_elements(JsonParser const& parser, uint32_t const* first, uint32_t const* last,
+			std::vector<Json>& out);
+
+		// the parsing core in njson/sax.h, shared by all handlers
+		template <typename Handler> bool parse_document(Handler& handler);
+		template <typename Handler> bool parse_value(Handler& handler, char c);
+		template <typename Handler> bool parse_scalar(Handler& handler, char c);
+
+		// an open container of parse_value(), the stack is kept between parses
+		struct Frame {
+			size_t	count;	// values so far
+			bool	object;
+		};
+		std::vector<Frame> frames;
+
+		// handler that builds the Json tree for parse() and feed()
+		class DomBuilder;
+
+		// the stacks of the DomBuilder, kept between parses so many small documents don't grow them every time
+		struct BuildStacks {
+			BuildStacks() : stamp(0) {}
+
+			std::vector<Json>		values;		// finished values whose container is still open
+			std::vector<Key>		members;	// keys of the values on the stack that are object members
+			std::vector<size_t>		slots;		// KeySchema slot of every key on the stack
+			std::vector<uint32_t>	seen;		// per slot, the stamp of the last object that had the key
+			uint32_t				stamp;		// of the last object built with a schema
+		};
+		BuildStacks build_stacks;
+
+		// reads the input for parse_into()
+		friend class JsonBinder;
 };
 
 } // namespace njson
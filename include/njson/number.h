@@ -0,0 +1,44 @@
+#ifndef NJSON_NUMBER_H
+# define NJSON_NUMBER_H
+
+# include <cstdint>
+
+namespace njson {
+
+/*
+	Parses the JSON number that starts at p, without allocating and
+	independent of the locale. On success p is moved past the number and
+	either i (is_float == false) or f (is_float == true) holds the value.
+
+	Numbers with a fraction or an exponent are floats, integers that don't
+	fit in an int64_t are promoted to float. Returns false if the input
+	isn't a valid JSON number or its magnitude is too large for a double.
+*/
+bool	parse_number(char const*& p, char const* end, int64_t& i, double& f, bool& is_float);
+
+// buffer size that is always enough for format_double(), format_float() and format_int()
+static const int	number_buffer_size = 32;
+
+/*
+	Writes the shortest decimal representation of f that parses back to
+	exactly the same double (Grisu2), and returns the end of the output.
+	The output always has a fraction or an exponent so it is read back as
+	a float. NaN and infinity have no JSON representation and become null.
+*/
+char*	format_double(char* buf, double f);
+
+/*
+	The same for a float: the shortest output that a float member reads
+	back as exactly the same float, through a double (0.1f is "0.1", not
+	the digits of the double it converts to). The rare float whose
+	shortest digits would round differently through the double gets the
+	digits of the double.
+*/
+char*	format_float(char* buf, float f);
+
+// writes the decimal representation of i and returns the end of the output
+char*	format_int(char* buf, int64_t i);
+
+} // namespace njson
+
+#endif // NJSON_NUMBER_H
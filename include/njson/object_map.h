@@ -0,0 +1,301 @@
+#ifndef NJSON_OBJECT_MAP_H
+# define NJSON_OBJECT_MAP_H
+
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <new>
+# include <utility>
+
+# include "njson/arena.h"
+# include "njson/key.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Insertion-ordered map from Key to V, used for the members of Json
+	objects. The members are stored in one contiguous array and looked up
+	with a linear scan. Once an object grows past index_threshold members
+	an open-addressing hash index (positions into the array, keyed by the
+	precomputed key hash) is built and kept up to date on insertion.
+
+	The interface follows the parts of std::map that Json uses: inserting
+	an existing key keeps the old member. Iterators are plain pointers and
+	are invalidated by insertion and erasure, like std::vector's.
+
+	Json objects hold the map inline, so it is kept to four words: the
+	counts are 32-bit and the size of the hash index is stored in front
+	of the index itself.
+*/
+template <typename V>
+class ObjectMap
+{
+	public:
+		using key_type = Key;
+		using mapped_type = V;
+		using value_type = std::pair<Key const, V>;
+		using allocator_type = ArenaAllocator<value_type>;
+		using size_type = size_t;
+		using iterator = value_type*;
+		using const_iterator = value_type const*;
+
+		// objects up to this size don't have a hash index
+		static const size_t index_threshold = 16;
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		ObjectMap() : ObjectMap(allocator_type()) {}
+		explicit ObjectMap(allocator_type const& alloc)
+			: alloc(alloc), members(nullptr), slots(nullptr), used(0), capacity(0) {}
+
+		ObjectMap(ObjectMap&& other) noexcept
+			: alloc(other.alloc), members(other.members), slots(other.slots), used(other.used),
+			capacity(other.capacity) {
+			other.release_storage();
+		}
+
+		// the allocator stays, the members of a map with another allocator are moved one by one
+		ObjectMap& operator=(ObjectMap&& other) {
+			if (this == &other)
+				return (*this);
+			destroy();
+			if (alloc != other.alloc) {
+				reserve(other.used);
+				for (value_type& member : other)
+					append(Key(std::move(const_cast<Key&>(member.first))), std::move(member.second));
+				other.clear();
+				return (*this);
+			}
+			members = other.members;
+			used = other.used;
+			capacity = other.capacity;
+			slots = other.slots;
+			other.release_storage();
+			return (*this);
+		}
+
+		ObjectMap(ObjectMap const& other) = delete;
+		ObjectMap& operator=(ObjectMap const& other) = delete;
+
+		~ObjectMap() { destroy(); }
+
+// ========================== METHODS ========================== //
+	public:
+		iterator begin(void) { return members; }
+		iterator end(void) { return members + used; }
+		const_iterator begin(void) const { return members; }
+		const_iterator end(void) const { return members + used; }
+
+		size_t size(void) const { return used; }
+		bool empty(void) const { return used == 0; }
+
+		allocator_type get_allocator(void) const { return alloc; }
+
+		iterator find(StringRef key) { return members + position(key); }
+		const_iterator find(StringRef key) const { return members + position(key); }
+		size_t count(StringRef key) const { return position(key) != used ? 1 : 0; }
+
+		// lookup with the precomputed Key::hash() of the key
+		iterator find(StringRef key, uint32_t hash) { return members + position(key, hash); }
+		const_iterator find(StringRef key, uint32_t hash) const { return members + position(key, hash); }
+
+		// adds the member unless the key is already present, returns the member with that key
+		std::pair<iterator, bool> emplace(Key const& key, V&& value) {
+			return (emplace_member(key, std::move(value)));
+		}
+
+		std::pair<iterator, bool> emplace(Key&& key, V&& value) {
+			return (emplace_member(std::move(key), std::move(value)));
+		}
+
+		std::pair<iterator, bool> insert(value_type&& member) {
+			return (emplace(member.first, std::move(member.second)));
+		}
+
+		// adds the member without looking for its key, which the caller knows isn't present
+		iterator append(Key const& key, V&& value) {
+			return (append_member(key, std::move(value)));
+		}
+
+		iterator append(Key&& key, V&& value) {
+			return (append_member(std::move(key), std::move(value)));
+		}
+
+		// removes the member, keeps the order of the others
+		iterator erase(const_iterator it) {
+			size_t	pos = it - members;
+			members[pos].~value_type();
+			for (size_t i = pos + 1; i < used; ++i) {
+				new (members + i - 1) value_type(std::move(members[i]));
+				members[i].~value_type();
+			}
+			--used;
+			if (slots != nullptr)
+				rebuild_index();
+			return (members + pos);
+		}
+
+		size_t erase(StringRef key) {
+			size_t	pos = position(key);
+			if (pos == used)
+				return (0);
+			erase(members + pos);
+			return (1);
+		}
+
+		void clear(void) {
+			for (size_t i = 0; i < used; ++i)
+				members[i].~value_type();
+			used = 0;
+			if (slots != nullptr)
+				std::memset(slots, 0, (slot_mask() + 1) * sizeof(uint32_t));
+		}
+
+		void reserve(size_t n) {
+			if (n > capacity)
+				reallocate(n);
+		}
+
+// ========================== PRIVATE ========================== //
+	private:
+		using slot_allocator = ArenaAllocator<uint32_t>;
+
+		template <typename K>
+		std::pair<iterator, bool> emplace_member(K&& key, V&& value) {
+			size_t	pos = slots ? indexed_position(key, key.hash()) : position(key);
+			if (pos != used)
+				return (std::make_pair(members + pos, false));
+			return (std::make_pair(append_member(std::forward<K>(key), std::move(value)), true));
+		}
+
+		template <typename K>
+		iterator append_member(K&& key, V&& value) {
+			if (used == capacity)
+				grow();
+			new (members + used) value_type(std::forward<K>(key), std::move(value));
+			++used;
+			if (slots != nullptr)
+				index_insert(used - 1);
+			else if (used > index_threshold)
+				rebuild_index();
+			return (members + used - 1);
+		}
+
+		// the index is preceded by its mask (number of slots - 1)
+		size_t slot_mask(void) const { return slots[-1]; }
+
+		// position of the member with the key, size() if there isn't one
+		size_t position(StringRef key) const {
+			if (slots == nullptr) {
+				for (size_t i = 0; i < used; ++i) {
+					Key const&	k = members[i].first;
+					if (k.size() == key.size() && std::memcmp(k.data(), key.data(), key.size()) == 0)
+						return (i);
+				}
+				return (used);
+			}
+			return (indexed_position(key, Key::hash(key.data(), key.size())));
+		}
+
+		size_t position(StringRef key, uint32_t h) const {
+			if (slots == nullptr) {
+				for (size_t i = 0; i < used; ++i) {
+					Key const&	k = members[i].first;
+					if (k.hash() == h && k.ref() == key)
+						return (i);
+				}
+				return (used);
+			}
+			return (indexed_position(key, h));
+		}
+
+		size_t indexed_position(StringRef key, uint32_t h) const {
+			size_t	mask = slot_mask();
+			for (size_t s = h & mask; slots[s] != 0; s = (s + 1) & mask) {
+				Key const&	k = members[slots[s] - 1].first;
+				if (k.hash() == h && k.ref() == key)
+					return (slots[s] - 1);
+			}
+			return (used);
+		}
+
+		void grow(void) {
+			reallocate(capacity == 0 ? 4 : capacity * 2);
+		}
+
+		void reallocate(size_t n) {
+			value_type*	moved = alloc.allocate(n);
+			for (size_t i = 0; i < used; ++i) {
+				new (moved + i) value_type(std::move(members[i]));
+				members[i].~value_type();
+			}
+			if (members != nullptr)
+				alloc.deallocate(members, capacity);
+			members = moved;
+			capacity = uint32_t(n);
+		}
+
+		// slots hold the position + 1 of a member, 0 is empty. At most half of them are used
+		void index_insert(size_t pos) {
+			size_t	mask = slot_mask();
+			if ((used * 2) > mask + 1) {
+				rebuild_index();
+				return ;
+			}
+			size_t	s = members[pos].first.hash() & mask;
+			while (slots[s] != 0)
+				s = (s + 1) & mask;
+			slots[s] = uint32_t(pos + 1);
+		}
+
+		void rebuild_index(void) {
+			free_index();
+
+			size_t	n = 64;
+			while (n < size_t(used) * 2)
+				n *= 2;
+			slots = slot_allocator(alloc.get_arena()).allocate(n + 1) + 1;
+			slots[-1] = uint32_t(n - 1);
+			std::memset(slots, 0, n * sizeof(uint32_t));
+			for (size_t i = 0; i < used; ++i) {
+				size_t	s = members[i].first.hash() & (n - 1);
+				while (slots[s] != 0)
+					s = (s + 1) & (n - 1);
+				slots[s] = uint32_t(i + 1);
+			}
+		}
+
+		void destroy(void) {
+			for (size_t i = 0; i < used; ++i)
+				members[i].~value_type();
+			if (members != nullptr)
+				alloc.deallocate(members, capacity);
+			free_index();
+			release_storage();
+		}
+
+		void free_index(void) {
+			if (slots != nullptr)
+				slot_allocator(alloc.get_arena()).deallocate(slots - 1, slot_mask() + 2);
+			slots = nullptr;
+		}
+
+		// forgets the storage without destroying it
+		void release_storage(void) {
+			members = nullptr;
+			used = 0;
+			capacity = 0;
+			slots = nullptr;
+		}
+
+		allocator_type	alloc;
+		value_type*		members;
+		uint32_t*		slots;
+		uint32_t		used;
+		uint32_t		capacity;
+};
+
+} // namespace njson
+
+#endif // NJSON_OBJECT_MAP_H
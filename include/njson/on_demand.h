@@ -0,0 +1,166 @@
+#ifndef NJSON_ON_DEMAND_H
+# define NJSON_ON_DEMAND_H
+
+# include <deque>
+# include <memory>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Document that is parsed on demand. Nothing is parsed up front, find(),
+	at() and get() only parse the values on the way to what they look up.
+	Containers are read one child at a time: the children that have to
+	be passed over are skipped with a scan that only balances brackets and
+	quotes, without building or checking anything inside them.
+
+	Every value that was reached is remembered, together with how far its
+	container was read, so looking something up again (or next to it)
+	doesn't read the input again. Skipped subtrees aren't validated, an
+	error is only noticed when the lookup reads through it (data after
+	the root value once a lookup reaches the end of the root).
+
+	Values are read through JsonOnDemand::Value, a lightweight view with
+	the is<T>(), get<T>() and find() vocabulary of JsonTape::Value. Lookups
+	fill the cache of the document, so a document (and its values) must not
+	be used from several threads at once. The input has to stay in place:
+	input read by JsonParser is kept alive by the document, a buffer passed
+	to JsonParser(data, length) has to outlive it.
+*/
+class JsonOnDemand
+{
+// =========================== VIEWS =========================== //
+	public:
+		class Value
+		{
+			public:
+				Value() : doc(nullptr), idx(0) {}
+				Value(JsonOnDemand const* doc, size_t idx) : doc(doc), idx(idx) {}
+
+			public:
+				Json::Type get_type(void) const;
+				std::string get_type_string(void) const { return Json::get_type_string(get_type()); }
+
+				// returns true if the template argument type matches the type of the value
+				template<typename T> bool is(void) const { return false; }
+
+				// returns the value as the type of the template argument, THROWs if the type doesn't match
+				// strings can be read as Json::string (a copy) or StringRef (points into the input)
+				template<typename T> T get(void) const {
+					throw(Json::json_exception("unsupported type"));
+				}
+
+				// number of elements of an array or members of an object (reads the whole container)
+				size_t size(void) const;
+
+				// object member lookup, returns a null value if the key isn't found
+				Value find(StringRef key) const;
+
+				template<typename... Args>
+				Value find(StringRef first, Args const&... keys) const {
+					return (find(first).find(keys...));
+				}
+
+				// array element (or the value of the object member) at index, null if out of range
+				Value at(size_t index) const;
+
+				// key of the object member at index, empty if out of range
+				StringRef key_at(size_t index) const;
+
+				// the value as a mutable Json tree, only this value is parsed completely
+				Json::pointer_t to_json(void) const;
+
+				operator bool() const { return get_type() != Json::NULL_T; }
+
+			private:
+				friend class JsonOnDemand;
+
+				void check_type(Json::Type type) const;
+
+				JsonOnDemand const*	doc;
+				size_t				idx;
+		};
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		JsonOnDemand();
+
+		// the document in [data, data + length), owner keeps that memory alive (may be null)
+		JsonOnDemand(char const* data, size_t length, std::shared_ptr<void const> owner = nullptr);
+
+		JsonOnDemand(JsonOnDemand&& other) = default;
+		JsonOnDemand& operator=(JsonOnDemand&& other) = default;
+
+		JsonOnDemand(JsonOnDemand const& other) = delete;
+		JsonOnDemand& operator=(JsonOnDemand const& other) = delete;
+
+// ========================== METHODS ========================== //
+	public:
+		// the root value, null if the document is empty
+		Value root(void) const;
+
+		// errors found while reading the input (malformed values on the path of a lookup)
+		bool has_error() const { return error; }
+		std::string const& get_error_msg(void) const { return errmsg; }
+
+		// number of values that were reached so far
+		size_t cached_values(void) const { return nodes.size(); }
+
+// ========================== PRIVATE ========================== //
+	private:
+		struct Child {
+			StringRef	key;	// empty for array elements
+			size_t		node;
+		};
+
+		struct Node {
+			char const*			begin;		// first character of the value
+			char const*			end;		// past the value, null while not known (containers)
+			char const*			resume;		// containers: where the next unknown child starts, null when all are known
+			Json::Type			type;
+			bool				escaped;	// strings: str still has to be decoded
+			StringRef			str;		// strings: the contents
+			std::vector<Child>	children;	// containers: the children found so far, in order
+		};
+
+		size_t add_node(char const* p) const;
+		bool read_child(size_t idx) const;
+		bool read_all(size_t idx) const;
+		char const* value_end(size_t idx) const;
+		void ended(size_t idx) const;
+		StringRef string_value(size_t idx) const;
+		StringRef decode(char const* begin, char const* end) const;
+		bool set_error(std::string const& str) const;
+
+		std::shared_ptr<void const>	owner;
+		char const*					data;
+		char const*					input_end;
+
+		mutable std::vector<Node>			nodes;
+		mutable std::deque<std::string>		decoded;	// strings and keys with escapes
+		mutable bool						error;
+		mutable std::string					errmsg;
+};
+
+template<> bool JsonOnDemand::Value::is<Json::null_t>(void) const;
+template<> bool JsonOnDemand::Value::is<Json::array>(void) const;
+template<> bool JsonOnDemand::Value::is<Json::object>(void) const;
+template<> bool JsonOnDemand::Value::is<Json::string>(void) const;
+template<> bool JsonOnDemand::Value::is<StringRef>(void) const;
+template<> bool JsonOnDemand::Value::is<Json::number_float>(void) const;
+template<> bool JsonOnDemand::Value::is<Json::number_int>(void) const;
+template<> bool JsonOnDemand::Value::is<bool>(void) const;
+
+template<> Json::string JsonOnDemand::Value::get<Json::string>(void) const;
+template<> StringRef JsonOnDemand::Value::get<StringRef>(void) const;
+template<> Json::number_float JsonOnDemand::Value::get<Json::number_float>(void) const;
+template<> Json::number_int JsonOnDemand::Value::get<Json::number_int>(void) const;
+template<> bool JsonOnDemand::Value::get<bool>(void) const;
+
+} // namespace njson
+
+#endif // NJSON_ON_DEMAND_H
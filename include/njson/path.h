@@ -0,0 +1,74 @@
+#ifndef NJSON_PATH_H
+# define NJSON_PATH_H
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+# include "njson/key.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Compiled JSON Pointer (RFC 6901), like "/servers/0/port". The pointer
+	is split into its segments once: escapes (~0 and ~1) are decoded,
+	every key is hashed and segments that can index an array are parsed
+	as numbers. Evaluating the path is then one lookup per segment, with
+	no string handling, so one path can be run against many documents.
+
+	A segment is used as a key on objects and as an index on arrays.
+	"-" (the element after the last) and anything that doesn't exist
+	finds a null-type node, like Json::find().
+*/
+class JsonPath
+{
+	public:
+		// segment that can't be an array index
+		static const size_t npos = size_t(-1);
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		// the empty path, which refers to the whole document
+		JsonPath() {}
+
+		// THROWs Json::json_exception if pointer isn't a valid JSON Pointer
+		explicit JsonPath(StringRef pointer);
+
+// ========================== METHODS ========================== //
+	public:
+		// the value the path points to in the document root, a null-type node if there is none
+		Json& find(Json& root) const;
+		Json const& find(Json const& root) const;
+
+		Json& find(Json::pointer_t& root) const { return find(*root); }
+		Json const& find(Json::pointer_t const& root) const { return find(*root); }
+
+		// number of segments
+		size_t size(void) const { return segments.size(); }
+		bool empty(void) const { return segments.empty(); }
+
+		// the decoded key of segment i
+		Key const& key(size_t i) const { return segments[i].key; }
+
+		// the array index of segment i, npos if it can't be one
+		size_t index(size_t i) const { return segments[i].index; }
+
+		// the pointer as it was given
+		std::string const& str(void) const { return pointer; }
+
+// ========================== PRIVATE ========================== //
+	private:
+		struct Segment {
+			Key		key;
+			size_t	index;	// npos if the segment isn't an array index
+		};
+
+		std::vector<Segment>	segments;
+		std::string				pointer;
+};
+
+} // namespace njson
+
+#endif // NJSON_PATH_H
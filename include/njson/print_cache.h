@@ -0,0 +1,135 @@
+#ifndef NJSON_PRINT_CACHE_H
+# define NJSON_PRINT_CACHE_H
+
+# include <cstddef>
+# include <iostream>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+# include "njson/key.h"
+# include "njson/path.h"
+# include "njson/string_ref.h"
+# include "njson/writer.h"
+
+namespace njson {
+
+/*
+	Serialized output of a Json tree that is printed again after every
+	small change (a config or state document that is kept in memory).
+	The cache keeps the output of the subtrees, so printing after a
+	change only serializes what changed and copies everything else:
+	subtrees whose output is at most chunk_size bytes are cached as one
+	fragment, larger containers are put together from the fragments of
+	their children. Every byte of the output is cached once.
+
+	Changes made through get<T>() references or insert() can't be seen
+	by the cache, so every change is reported with invalidate(), with the
+	JSON Pointer of the value that changed, was added or was removed.
+	That drops the fragment the value is part of, the fragments of the
+	containers around it stay and only the path from the root down to
+	the change is written again. Members added to or erased from an
+	object are found by their key, an array that had elements inserted or
+	erased anywhere but at the end has to be invalidated as a whole.
+	After replacing the root or changing the indentation string, clear().
+
+		JsonPrintCache	cache(*config);
+		config->find("limits", "max_connections").get<Json::number_int>() = 512;
+		cache.invalidate("/limits/max_connections");
+		out << cache.str();
+*/
+class JsonPrintCache
+{
+	public:
+		static const size_t default_chunk_size = 4096;
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		// the tree has to outlive the cache, nothing is serialized before the first str()
+		explicit JsonPrintCache(Json const& root, bool pretty = true, size_t chunk_size = default_chunk_size);
+
+		JsonPrintCache(JsonPrintCache const& other) = delete;
+		JsonPrintCache& operator=(JsonPrintCache const& other) = delete;
+
+// ========================== METHODS ========================== //
+	public:
+		// the output of the tree, the same as Json::to_string(). Valid until the next call
+		std::string const& str(void);
+
+		// str() followed by a newline, like Json::print()
+		void print(std::ostream& out = std::cout);
+
+		// the value at pointer (a JSON Pointer, "" for the root) changed, was added or was removed
+		void invalidate(JsonPath const& path);
+		void invalidate(StringRef pointer) { invalidate(JsonPath(pointer)); }
+
+		// forgets all cached output
+		void clear(void);
+
+		bool get_pretty(void) const { return writer.get_pretty(); }
+		size_t get_chunk_size(void) const { return chunk_size; }
+
+// ========================== PRIVATE ========================== //
+	private:
+		/*
+			The cache of one value. A fragment is CACHED (bytes is its output),
+			ASSEMBLED (a large container with a fragment per child, in the order
+			of its children, with their keys for objects) or INVALID. PENDING is
+			a fragment that was just written and will be part of its parent's
+			fragment if the parent turns out small enough: start and size locate
+			its output until the parent decides.
+		*/
+		struct Fragment {
+			enum State { INVALID, CACHED, PENDING, ASSEMBLED };
+
+			Fragment() : state(INVALID), start(0), size(0) {}
+			Fragment(Fragment&& other) = default;
+			Fragment& operator=(Fragment&& other) = default;
+			~Fragment();
+
+			void reset(void);
+
+			State					state;
+			std::string				bytes;
+			size_t					start;
+			size_t					size;
+			Key						key;		// of object members
+			std::vector<Fragment>	children;	// of an assembled container
+		};
+
+		/*
+			A container whose children are being written, next is the child
+			after the last written one. building: its parent is being built,
+			builds: it's being built itself (its output starts at start).
+		*/
+		struct OpenFragment {
+			Json const*	json;
+			Fragment*	fragment;
+			size_t		depth;
+			size_t		next;
+			size_t		start;
+			bool		building;
+			bool		builds;
+		};
+
+		void write(Json const& json, size_t depth, Fragment& fragment, bool building);
+		bool begin(Json const& json, size_t depth, Fragment& fragment);
+		void end(OpenFragment const& value);
+		void build(Fragment& fragment, size_t start);
+
+		// the fragments of an assembled object, after members were added or erased
+		void match_members(Json::object const& obj, Fragment& fragment);
+
+		// a written child, its parent is assembled: a pending child gets its own bytes
+		void keep(Fragment& child);
+
+		Json const&					root;
+		JsonWriter					writer;
+		size_t						chunk_size;
+		Fragment					tree;
+		std::vector<OpenFragment>	open;
+};
+
+} // namespace njson
+
+#endif // NJSON_PRINT_CACHE_H
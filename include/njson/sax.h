@@ -0,0 +1,228 @@
+#ifndef NJSON_SAX_H
+# define NJSON_SAX_H
+
+# include <algorithm>
+# include <cstddef>
+# include <string>
+
+# include "njson/njson.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Event interface of JsonParser::parse(Handler&). The parser calls the
+	handler for every value in document order, without building a tree:
+
+		on_object_start()  on_key(key)  <value>  ...  on_object_end(members)
+		on_array_start()   <value>  ...  on_array_end(elements)
+
+	Strings and keys are passed decoded, the StringRef is only valid during
+	the call. Every callback returns true to continue or false to stop the
+	parse (the parser then reports "stopped by handler").
+
+	The handler is a template argument, so handlers don't have to derive
+	from JsonHandler. Deriving from it supplies no-op defaults for the
+	events a handler isn't interested in.
+*/
+class JsonHandler
+{
+	public:
+		bool on_null(void) { return (true); }
+		bool on_bool(bool) { return (true); }
+		bool on_int(Json::number_int) { return (true); }
+		bool on_double(Json::number_float) { return (true); }
+		bool on_string(StringRef) { return (true); }
+		bool on_key(StringRef) { return (true); }
+		bool on_object_start(void) { return (true); }
+		bool on_object_end(size_t) { return (true); }
+		bool on_array_start(void) { return (true); }
+		bool on_array_end(size_t) { return (true); }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+template <typename Handler>
+bool JsonParser::parse(Handler& handler) {
+	return (start_input() && parse_document(handler));
+}
+
+// an empty input has no events, a document is one value with only whitespace after it
+template <typename Handler>
+bool JsonParser::parse_document(Handler& handler) {
+	if (cur == end) {
+		return (true);
+	}
+	return (parse_value(handler, *cur++) && end_document());
+}
+
+// a scalar value, c is its first character and cur is just past it
+template <typename Handler>
+bool JsonParser::parse_scalar(Handler& handler, char c) {
+	switch (get_state_from_c(c)) {
+		case STRING : {
+			StringRef	str;
+			if (!scan_string_ref(str)) {
+				return (false);
+			}
+			return (handler.on_string(str) || stopped());
+		}
+		case NUMBER : {
+			Json::number_int	_int;
+			Json::number_float	_float;
+			bool				is_float;
+
+			--cur;
+			if (!scan_number(_int, _float, is_float)) {
+				return (false);
+			}
+			if (is_float) {
+				return (handler.on_double(_float) || stopped());
+			}
+			return (handler.on_int(_int) || stopped());
+		}
+		case WORD :
+		default : {
+			--cur;
+			switch (scan_word()) {
+				case 't' : return (handler.on_bool(true) || stopped());
+				case 'f' : return (handler.on_bool(false) || stopped());
+				case 'n' : return (handler.on_null() || stopped());
+				default : return (false);
+			}
+		}
+	}
+}
+
+/*
+	Parses one complete value, c is its first character and cur is just
+	past it. Nesting doesn't recurse: the open containers (and their
+	element counts) are kept on the frames stack and the loop moves
+	between four steps:
+
+		VALUE		c starts a value, containers are opened here
+		KEY			cur is at the next key of the innermost object
+		ELEMENT		cur is at the next element of the innermost array
+		NEXT		a value just ended, expect ',' or the closing bracket
+*/
+template <typename Handler>
+bool JsonParser::parse_value(Handler& handler, char c) {
+	enum Step { VALUE, KEY, ELEMENT, NEXT };
+
+	Step	step = VALUE;
+
+	// kept between parses, so after the first document this doesn't allocate
+	frames.clear();
+	frames.reserve(std::min<size_t>(max_depth, 64));
+
+	while (true) {
+		switch (step) {
+			case VALUE :
+				if (c == '{' || c == '[') {
+					bool	object = (c == '{');
+					if (frames.size() >= max_depth) {
+						return (set_error("document too deep, nested more than " + std::to_string(max_depth) + " levels"));
+					}
+					if (!(object ? handler.on_object_start() : handler.on_array_start())) {
+						return (stopped());
+					}
+					skip_ws();
+					if (cur < end && *cur == (object ? '}' : ']')) {
+						++cur;
+						if (!(object ? handler.on_object_end(0) : handler.on_array_end(0))) {
+							return (stopped());
+						}
+						step = NEXT;
+						break ;
+					}
+					frames.push_back(Frame{0, object});
+					step = object ? KEY : ELEMENT;
+					break ;
+				}
+				if (!parse_scalar(handler, c)) {
+					return (false);
+				}
+				step = NEXT;
+				break ;
+
+			case KEY : {
+				if (cur == end) {
+					return (set_error("object not closed by '}'"));
+				}
+				if (*cur != '\"') {
+					if (is_delimiter(*cur)) {
+						return (set_error(std::string{"bad object, unexpected token: '"} + *cur + '\''));
+					}
+					return (set_error("bad object, key not encapsulated by quotes"));
+				}
+				++cur;
+
+				StringRef	key;
+				if (!scan_string_ref(key)) {
+					return (false);
+				}
+				if (!handler.on_key(key)) {
+					return (stopped());
+				}
+
+				skip_ws();
+				if (cur == end || *cur != ':') {
+					return (set_error("bad object, key not followed by ':'"));
+				}
+				++cur;
+				skip_ws();
+				if (cur == end) {
+					return (set_error("object not closed by '}'"));
+				}
+				c = *cur++;
+				step = VALUE;
+				break ;
+			}
+
+			case ELEMENT :
+				if (cur == end) {
+					return (set_error("array not closed by ']'"));
+				}
+				c = *cur++;
+				step = VALUE;
+				break ;
+
+			case NEXT :
+			default : {
+				if (frames.empty()) {
+					return (true);
+				}
+				Frame&	frame = frames.back();
+				++frame.count;
+
+				skip_ws();
+				if (cur == end) {
+					return (set_error(frame.object ? "object not closed by '}'" : "array not closed by ']'"));
+				}
+				if (*cur == (frame.object ? '}' : ']')) {
+					++cur;
+					size_t	count = frame.count;
+					bool	object = frame.object;
+					frames.pop_back();
+					if (!(object ? handler.on_object_end(count) : handler.on_array_end(count))) {
+						return (stopped());
+					}
+					break ;
+				}
+				if (*cur != ',') {
+					return (set_error(frame.object ? "bad object, elements not seperated by ','" : "bad array, elements not seperated by ','"));
+				}
+				++cur;
+				skip_ws();
+				step = frame.object ? KEY : ELEMENT;
+				break ;
+			}
+		}
+	}
+}
+
+} // namespace njson
+
+#endif // NJSON_SAX_H
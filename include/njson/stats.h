@@ -0,0 +1,66 @@
+#ifndef NJSON_STATS_H
+# define NJSON_STATS_H
+
+# include <cstddef>
+
+namespace njson {
+
+/*
+	Statistics of the last JsonParser::parse(), to export to a metrics
+	system or to catch pathological inputs (deep nesting, huge strings,
+	allocation heavy documents). Collecting them costs time on every
+	value, so they're only compiled in when njson is built with
+	NJSON_STATS (cmake -DNJSON_STATS=ON). Without it every field stays
+	zero and the hooks in the parser compile to nothing.
+
+	The phases split the time of parse(): number conversion, building
+	the tree (the handler calls), and tokenize being the rest (indexing
+	and scanning the input). They're wall clock times estimated from a
+	sample of the calls. A parse() on several threads sums the phases
+	over its threads (which includes time a thread waits for a core),
+	the total is the wall time.
+*/
+struct ParseStats {
+# ifdef NJSON_STATS
+	static constexpr bool	enabled = true;
+# else
+	static constexpr bool	enabled = false;
+# endif
+
+	size_t	bytes;				// input consumed
+	size_t	nodes[7];			// values per Json::Type
+	size_t	max_depth;			// deepest nesting of arrays and objects
+	size_t	string_bytes;		// decoded bytes of string values and keys
+	size_t	allocations;		// heap allocations for the document (arena blocks, nodes, strings)
+	size_t	allocated_bytes;
+
+	double	total_seconds;
+	double	tokenize_seconds;
+	double	number_seconds;
+	double	build_seconds;
+
+	ParseStats()
+	: bytes(0), nodes(), max_depth(0), string_bytes(0), allocations(0), allocated_bytes(0),
+	total_seconds(0), tokenize_seconds(0), number_seconds(0), build_seconds(0) {}
+
+	size_t	node_count(void) const {
+		size_t	total = 0;
+		for (size_t n : nodes)
+			total += n;
+		return (total);
+	}
+};
+
+// statements that only exist in builds with NJSON_STATS
+# ifdef NJSON_STATS
+#  define NJSON_STAT(...) __VA_ARGS__
+
+// counts a heap allocation of the document that is being parsed on this thread (if any)
+void	stats_allocation(size_t bytes);
+# else
+#  define NJSON_STAT(...)
+# endif
+
+} // namespace njson
+
+#endif // NJSON_STATS_H
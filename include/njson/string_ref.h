@@ -0,0 +1,58 @@
+#ifndef NJSON_STRING_REF_H
+# define NJSON_STRING_REF_H
+
+# include <cstddef>
+# include <cstring>
+# include <ostream>
+# include <string>
+
+namespace njson {
+
+/*
+	Non-owning reference to a range of characters (like std::string_view,
+	which isn't available in C++11). The referenced memory has to outlive it.
+*/
+class StringRef
+{
+	public:
+		StringRef() : ptr(""), len(0) {}
+		StringRef(char const* ptr, size_t len) : ptr(ptr), len(len) {}
+		StringRef(char const* str) : ptr(str), len(std::strlen(str)) {}
+		StringRef(std::string const& str) : ptr(str.data()), len(str.size()) {}
+
+	public:
+		char const* data(void) const { return ptr; }
+		size_t size(void) const { return len; }
+		bool empty(void) const { return len == 0; }
+
+		char const* begin(void) const { return ptr; }
+		char const* end(void) const { return ptr + len; }
+		char operator[](size_t i) const { return ptr[i]; }
+
+		std::string str(void) const { return std::string(ptr, len); }
+
+		int compare(StringRef const& other) const {
+			int r = std::memcmp(ptr, other.ptr, len < other.len ? len : other.len);
+			if (r != 0)
+				return (r);
+			return (len < other.len ? -1 : (len > other.len ? 1 : 0));
+		}
+
+		friend bool operator==(StringRef const& lhs, StringRef const& rhs) {
+			return (lhs.len == rhs.len && std::memcmp(lhs.ptr, rhs.ptr, lhs.len) == 0);
+		}
+		friend bool operator!=(StringRef const& lhs, StringRef const& rhs) { return !(lhs == rhs); }
+		friend bool operator<(StringRef const& lhs, StringRef const& rhs) { return lhs.compare(rhs) < 0; }
+
+		friend std::ostream& operator<<(std::ostream& out, StringRef const& ref) {
+			return (out.write(ref.ptr, ref.len));
+		}
+
+	private:
+		char const*	ptr;
+		size_t		len;
+};
+
+} // namespace njson
+
+#endif // NJSON_STRING_REF_H
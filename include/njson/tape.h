@@ -0,0 +1,204 @@
+#ifndef NJSON_TAPE_H
+# define NJSON_TAPE_H
+
+# include <cstdint>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+# include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Immutable, flat representation of a parsed document. Every value is one
+	or two 64-bit words on a single tape (numbers store their payload in
+	the next word) and strings live in one shared buffer. Objects and
+	arrays store the index just past their end, so skipping a subtree is
+	a single jump.
+
+	Values are read through JsonTape::Value, a lightweight view (tape +
+	index) with the same is<T>(), get<T>() and find() vocabulary as Json.
+*/
+class JsonTape
+{
+// =========================== TAPE ============================ //
+	public:
+		enum Tag : uint8_t {
+			TAG_NULL = 'n',
+			TAG_TRUE = 't',
+			TAG_FALSE = 'f',
+			TAG_INT = 'l',
+			TAG_FLOAT = 'd',
+			TAG_STRING = '"',
+			TAG_OBJECT = '{',
+			TAG_OBJECT_END = '}',
+			TAG_ARRAY = '[',
+			TAG_ARRAY_END = ']'
+		};
+
+		static uint64_t make_word(Tag tag, uint64_t payload) { return (uint64_t(tag) << 56) | payload; }
+		static Tag word_tag(uint64_t word) { return Tag(word >> 56); }
+		static uint64_t word_payload(uint64_t word) { return word & ((uint64_t(1) << 56) - 1); }
+
+		// containers: low 32 bits are the index past the end, the upper 24 bits the (saturated) element count
+		static const uint64_t max_count = (uint64_t(1) << 24) - 1;
+
+// =========================== VIEWS =========================== //
+	public:
+		class Value;
+		class ArrayIterator;
+		class ObjectIterator;
+
+		class Value
+		{
+			public:
+				Value() : tape(nullptr), idx(0) {}
+				Value(JsonTape const* tape, size_t idx) : tape(tape), idx(idx) {}
+
+			public:
+				Json::Type get_type(void) const;
+				std::string get_type_string(void) const { return Json::get_type_string(get_type()); }
+
+				// returns true if the template argument type matches the type of the value
+				template<typename T> bool is(void) const { return false; }
+
+				// returns the value as the type of the template argument, THROWs if the type doesn't match
+				// strings can be read as Json::string (a copy) or StringRef (points into the tape)
+				template<typename T> T get(void) const {
+					throw(Json::json_exception("unsupported type"));
+				}
+
+				// number of elements of an array or members of an object
+				size_t size(void) const;
+
+				// object member lookup, returns a null value if the key isn't found
+				Value find(StringRef key) const;
+
+				template<typename... Args>
+				Value find(StringRef first, Args const&... keys) const {
+					return (find(first).find(keys...));
+				}
+
+				// array element lookup, returns a null value if out of range
+				Value at(size_t index) const;
+
+				ArrayIterator begin_array(void) const;
+				ArrayIterator end_array(void) const;
+				ObjectIterator begin_object(void) const;
+				ObjectIterator end_object(void) const;
+
+				// deep copy into a mutable Json tree
+				Json::pointer_t to_json(void) const;
+
+				operator bool() const { return get_type() != Json::NULL_T; }
+
+			private:
+				friend class JsonTape;
+
+				uint64_t word(void) const { return tape->tape[idx]; }
+				Json make_json(void) const;
+				StringRef string_ref(void) const { return tape->string_at(word_payload(word())); }
+				void check_tag(Json::Type type) const;
+
+				JsonTape const*	tape;
+				size_t			idx;
+		};
+
+		// iterates the elements of an array
+		class ArrayIterator
+		{
+			public:
+				ArrayIterator(JsonTape const* tape, size_t idx) : tape(tape), idx(idx) {}
+
+				Value operator*(void) const { return Value(tape, idx); }
+				ArrayIterator& operator++(void) { idx = tape->next(idx); return (*this); }
+				bool operator==(ArrayIterator const& other) const { return idx == other.idx; }
+				bool operator!=(ArrayIterator const& other) const { return idx != other.idx; }
+
+			private:
+				JsonTape const*	tape;
+				size_t			idx;
+		};
+
+		// iterates the members of an object, key() and value() of the current member
+		class ObjectIterator
+		{
+			public:
+				ObjectIterator(JsonTape const* tape, size_t idx) : tape(tape), idx(idx) {}
+
+				StringRef key(void) const { return tape->string_at(word_payload(tape->tape[idx])); }
+				Value value(void) const { return Value(tape, idx + 1); }
+				ObjectIterator& operator++(void) { idx = tape->next(idx + 1); return (*this); }
+				bool operator==(ObjectIterator const& other) const { return idx == other.idx; }
+				bool operator!=(ObjectIterator const& other) const { return idx != other.idx; }
+
+			private:
+				JsonTape const*	tape;
+				size_t			idx;
+		};
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		JsonTape() {}
+
+		JsonTape(JsonTape&& other) = default;
+		JsonTape& operator=(JsonTape&& other) = default;
+
+		JsonTape(JsonTape const& other) = delete;
+		JsonTape& operator=(JsonTape const& other) = delete;
+
+// ========================== METHODS ========================== //
+	public:
+		// the root value, null if the tape is empty
+		Value root(void) const;
+
+		bool empty(void) const { return tape.empty(); }
+		void clear(void) { tape.clear(); strings.clear(); }
+
+		// deep copy of the whole document into a mutable Json tree
+		Json::pointer_t to_json(void) const { return root().to_json(); }
+
+		// memory used by the tape and the string buffer
+		size_t memory_usage(void) const { return tape.capacity() * sizeof(uint64_t) + strings.capacity(); }
+
+// ========================== BUILDING ========================= //
+	public:
+		void push(Tag tag, uint64_t payload = 0) { tape.push_back(make_word(tag, payload)); }
+		void push_int(Json::number_int i);
+		void push_float(Json::number_float f);
+		void push_string(char const* str, size_t len);
+
+		// containers are opened with a placeholder that close_container() fills in
+		size_t open_container(Tag tag) { tape.push_back(make_word(tag, 0)); return tape.size() - 1; }
+		void close_container(size_t start, Tag end_tag, size_t count);
+
+		std::string& string_buffer(void) { return strings; }
+
+// ========================== PRIVATE ========================== //
+	private:
+		size_t next(size_t idx) const;
+		StringRef string_at(uint64_t offset) const;
+
+		std::vector<uint64_t>	tape;
+		std::string				strings;
+};
+
+template<> bool JsonTape::Value::is<Json::null_t>(void) const;
+template<> bool JsonTape::Value::is<Json::array>(void) const;
+template<> bool JsonTape::Value::is<Json::object>(void) const;
+template<> bool JsonTape::Value::is<Json::string>(void) const;
+template<> bool JsonTape::Value::is<StringRef>(void) const;
+template<> bool JsonTape::Value::is<Json::number_float>(void) const;
+template<> bool JsonTape::Value::is<Json::number_int>(void) const;
+template<> bool JsonTape::Value::is<bool>(void) const;
+
+template<> Json::string JsonTape::Value::get<Json::string>(void) const;
+template<> StringRef JsonTape::Value::get<StringRef>(void) const;
+template<> Json::number_float JsonTape::Value::get<Json::number_float>(void) const;
+template<> Json::number_int JsonTape::Value::get<Json::number_int>(void) const;
+template<> bool JsonTape::Value::get<bool>(void) const;
+
+} // namespace njson
+
+#endif // NJSON_TAPE_H
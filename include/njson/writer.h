@@ -0,0 +1,108 @@
+#ifndef NJSON_WRITER_H
+# define NJSON_WRITER_H
+
+# include <cstddef>
+# include <functional>
+# include <iostream>
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+
+namespace njson {
+
+/*
+	Serializes Json trees into one contiguous, growable buffer. Without a
+	sink the output accumulates and can be taken with str() or release().
+	With a sink the buffer is handed over in bulk whenever it grows past
+	the flush size, and once more by flush().
+
+	Pretty output puts every element on its own line, indented with
+	Json::get_indentation_string(). Compact output has no whitespace.
+	Writing doesn't recurse: the open containers are kept on a stack, so
+	a tree of any depth can be written.
+*/
+class JsonWriter
+{
+	public:
+		// receives the serialized output in chunks
+		using sink_t = std::function<void(char const* data, size_t size)>;
+
+		static const size_t default_flush_size = 64 * 1024;
+
+// ======================== CONSTRUCTOR ======================== //
+	public:
+		explicit JsonWriter(bool pretty = true);
+		JsonWriter(sink_t sink, bool pretty = true, size_t flush_size = default_flush_size);
+		JsonWriter(std::ostream& out, bool pretty = true, size_t flush_size = default_flush_size);
+
+		JsonWriter(JsonWriter const& other) = delete;
+		JsonWriter& operator=(JsonWriter const& other) = delete;
+
+		// remaining output is flushed to the sink
+		~JsonWriter() { flush(); }
+
+// ========================== METHODS ========================== //
+	public:
+		void write(Json const& json);
+		void write(Json::pointer_t const& json) { write(*json); }
+
+		// append raw characters to the output
+		void write_raw(char const* data, size_t size) { buffer.append(data, size); }
+		void write_raw(char c) { buffer.push_back(c); }
+
+		// hands the buffered output to the sink (no-op without a sink)
+		void flush(void);
+
+		// the output so far (without a sink: everything written)
+		std::string const& str(void) const { return buffer; }
+		std::string release(void);
+		void clear(void) { buffer.clear(); }
+
+		void set_pretty(bool use) { pretty = use; }
+		bool get_pretty(void) const { return pretty; }
+
+		// appends str as a quoted JSON string, escaping quotes, backslashes and control characters
+		static void append_string(std::string& out, char const* str, size_t len);
+
+// ========================== PRIVATE ========================== //
+	private:
+		// a container whose children are being written, next is the child after the last written one
+		struct OpenValue {
+			Json const*	json;
+			size_t		next;
+			size_t		depth;
+		};
+
+		// writes json, a value nested depth levels deep
+		void write_tree(Json const& json, size_t depth);
+		// writes a scalar, or the start of a container that is then opened (empty ones are written whole)
+		void write_value(Json const& json, size_t depth);
+		void write_indent(size_t depth);
+
+		// the punctuation around the members and elements of a container at depth,
+		// begin_object() and begin_array() write an empty container whole and return false
+		bool begin_object(size_t size);
+		void begin_member(Key const& key, size_t depth);
+		void end_member(bool last);
+		void end_object(size_t depth);
+		bool begin_array(size_t size, size_t depth);
+		void begin_element(size_t depth);
+		void end_element(bool last);
+		void end_array(size_t depth);
+
+		void flush_if_full(void) { if (sink && buffer.size() >= flush_size) flush(); }
+
+		// writes the parts that changed and copies the rest
+		friend class JsonPrintCache;
+
+		std::string				buffer;
+		std::vector<OpenValue>	open;
+		sink_t					sink;
+		size_t		flush_size;
+		bool		pretty;
+};
+
+} // namespace njson
+
+#endif // NJSON_WRITER_H
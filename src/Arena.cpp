@@ -0,0 +1,88 @@
+#include "njson/arena.h"
+
+#include <cstdint>
+
+namespace njson {
+
+// first block size, every next block doubles up to the maximum
+static const size_t	initial_block_size = size_t(64) << 10;
+static const size_t	max_block_size = size_t(4) << 20;
+static const size_t	min_block_size = size_t(1) << 10;
+
+Arena::Arena()
+: blocks(nullptr), cur(nullptr), end(nullptr), next_size(initial_block_size), reserved(0), refs(0), shared(false) {}
+
+Arena::Arena(size_t first_block) : Arena() {
+	if (first_block < min_block_size)
+		next_size = min_block_size;
+	else if (first_block < initial_block_size)
+		next_size = first_block;
+}
+
+Arena::~Arena() {
+	while (blocks != nullptr) {
+		Block* next = blocks->next;
+		::operator delete(blocks);
+		blocks = next;
+	}
+}
+
+static char*	align_up(char* p, size_t align) {
+	uintptr_t	v = reinterpret_cast<uintptr_t>(p);
+	return (reinterpret_cast<char*>((v + align - 1) & ~uintptr_t(align - 1)));
+}
+
+void*	Arena::allocate(size_t size, size_t align) {
+	if (shared) {
+		std::lock_guard<std::mutex>	lock(mutex);
+		return (allocate_unlocked(size, align));
+	}
+	return (allocate_unlocked(size, align));
+}
+
+void*	Arena::allocate_unlocked(size_t size, size_t align) {
+	char*	p = align_up(cur, align);
+	if (cur != nullptr && p + size <= end) {
+		cur = p + size;
+		return (p);
+	}
+	return (allocate_block(size, align));
+}
+
+void*	Arena::allocate_block(size_t size, size_t align) {
+	size_t	needed = sizeof(Block) + size + align;
+
+	// oversized requests get a block of their own, the current block stays in use
+	if (needed > next_size) {
+		Block* block = static_cast<Block*>(::operator new(needed));
+		NJSON_STAT(stats_allocation(needed));
+		block->size = needed;
+		reserved += needed;
+		if (blocks != nullptr) {
+			block->next = blocks->next;
+			blocks->next = block;
+		} else {
+			block->next = nullptr;
+			blocks = block;
+		}
+		return (align_up(reinterpret_cast<char*>(block + 1), align));
+	}
+
+	Block* block = static_cast<Block*>(::operator new(next_size));
+	NJSON_STAT(stats_allocation(next_size));
+	block->next = blocks;
+	block->size = next_size;
+	blocks = block;
+	reserved += next_size;
+
+	cur = reinterpret_cast<char*>(block + 1);
+	end = reinterpret_cast<char*>(block) + next_size;
+	if (next_size < max_block_size)
+		next_size *= 2;
+
+	char*	p = align_up(cur, align);
+	cur = p + size;
+	return (p);
+}
+
+} // namespace njson
@@ -0,0 +1,355 @@
+#include "njson/njson.h"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace njson {
+
+/*
+	Binary snapshots of Json trees, for documents that are loaded far
+	more often than they change. The format is native to njson:
+
+		header		"NJSB" and a version byte
+		key table	count, then every distinct object key: length + bytes
+		value		a tag byte (the JsonTape tags) and its payload:
+			'n' 't' 'f'		null, true, false
+			'l'				zigzag encoded integer
+			'd'				8 bytes, the little-endian IEEE double
+			'"'				length + bytes, already decoded
+			'['				element count, then the elements
+			'{'				member count, then per member: key number + value
+
+	Counts, lengths and integers are LEB128 varints. Keys are stored once
+	and members refer to them by number, so loading hashes every distinct
+	key once. Containers know their size up front, so every container is
+	allocated at its exact size and filled in place.
+*/
+
+static const char		snapshot_magic[4] = {'N', 'J', 'S', 'B'};
+static const char		snapshot_version = 1;
+
+/* -------------------------------------------------------------------------- */
+/*                                   Writing                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+struct KeyHash {
+	size_t	operator()(Key const& key) const { return (key.hash()); }
+};
+
+class SnapshotWriter
+{
+	public:
+		// without recursion, so a tree of any depth can be saved (loading applies the depth limit)
+		void write(Json const& root) {
+			write_value(root);
+			while (!open.empty()) {
+				OpenValue&	container = open.back();
+				if (container.json->get_type() == Json::ARRAY) {
+					Json::array const&	arr = container.json->get<Json::array>();
+					if (container.next == arr.size()) {
+						open.pop_back();
+						continue ;
+					}
+					write_value(arr[container.next++]);
+				} else {
+					Json::object const&	obj = container.json->get<Json::object>();
+					if (container.next == obj.size()) {
+						open.pop_back();
+						continue ;
+					}
+					auto const&	member = obj.begin()[container.next++];
+					put_varint(values, key_number(member.first));
+					write_value(member.second);
+				}
+			}
+		}
+
+		std::string finish(void) {
+			std::string	out(snapshot_magic, sizeof(snapshot_magic));
+			out.push_back(snapshot_version);
+			put_varint(out, keys.size());
+			for (Key const& key : keys) {
+				put_varint(out, key.size());
+				out.append(key.data(), key.size());
+			}
+			out.append(values);
+			return (out);
+		}
+
+	private:
+		// a container whose children are being written, next is the child after the last written one
+		struct OpenValue {
+			Json const*	json;
+			size_t		next;
+		};
+
+		// writes a scalar, or the tag and size of a container that is then opened
+		void write_value(Json const& json) {
+			switch (json.get_type()) {
+				case Json::NULL_T :
+					values.push_back('n');
+					break ;
+				case Json::BOOL :
+					values.push_back(json.get<bool>() ? 't' : 'f');
+					break ;
+				case Json::NUMBER_INT : {
+					uint64_t	n = uint64_t(json.get<Json::number_int>());
+					values.push_back('l');
+					put_varint(values, (n << 1) ^ (0 - (n >> 63)));
+					break ;
+				}
+				case Json::NUMBER_FLOAT : {
+					uint64_t	bits;
+					Json::number_float	f = json.get<Json::number_float>();
+					std::memcpy(&bits, &f, sizeof(bits));
+					values.push_back('d');
+					for (int i = 0; i < 8; ++i)
+						values.push_back(char(bits >> (i * 8)));
+					break ;
+				}
+				case Json::STRING : {
+					StringRef	str = json.get_string_ref();
+					values.push_back('\"');
+					put_varint(values, str.size());
+					values.append(str.data(), str.size());
+					break ;
+				}
+				case Json::ARRAY :
+					values.push_back('[');
+					put_varint(values, json.get<Json::array>().size());
+					open.push_back(OpenValue{&json, 0});
+					break ;
+				case Json::OBJECT :
+					values.push_back('{');
+					put_varint(values, json.get<Json::object>().size());
+					open.push_back(OpenValue{&json, 0});
+					break ;
+				default :
+					values.push_back('n');
+			}
+		}
+
+		static void put_varint(std::string& out, uint64_t n) {
+			while (n >= 0x80) {
+				out.push_back(char(n | 0x80));
+				n >>= 7;
+			}
+			out.push_back(char(n));
+		}
+
+		size_t key_number(Key const& key) {
+			auto	it = numbers.find(key);
+			if (it != numbers.end())
+				return (it->second);
+			numbers.emplace(key, keys.size());
+			keys.push_back(key);
+			return (keys.size() - 1);
+		}
+
+		std::string								values;
+		std::vector<OpenValue>					open;
+		std::vector<Key>						keys;
+		std::unordered_map<Key, size_t, KeyHash>	numbers;
+};
+
+} // namespace
+
+std::string Json::to_binary(void) const {
+	SnapshotWriter	writer;
+	writer.write(*this);
+	return (writer.finish());
+}
+
+void Json::save_binary(std::ostream& out) const {
+	std::string	snapshot = to_binary();
+	out.write(snapshot.data(), snapshot.size());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Loading                                  */
+/* -------------------------------------------------------------------------- */
+
+static bool	read_varint(char const*& p, char const* end, uint64_t& n) {
+	n = 0;
+	for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+		unsigned char	c = *p++;
+		n |= uint64_t(c & 0x7f) << shift;
+		if ((c & 0x80) == 0)
+			return (true);
+	}
+	return (false);
+}
+
+namespace {
+
+// a container that is being filled, it's reserved at its size so the values don't move
+struct OpenContainer {
+	Json::array*	elements;	// one of the two is set
+	Json::object*	members;
+	uint64_t		left;
+};
+
+} // namespace
+
+// constructs the value in place: the root, the next element or the member with key (null for a duplicate key)
+template <typename T>
+static Json*	place(Json& root, OpenContainer* parent, Key const* key, T&& value) {
+	if (parent == nullptr) {
+		root = Json(std::forward<T>(value));
+		return (&root);
+	}
+	if (parent->elements != nullptr) {
+		parent->elements->emplace_back(std::forward<T>(value));
+		return (&parent->elements->back());
+	}
+	auto	member = parent->members->emplace(*key, Json(std::forward<T>(value)));
+	return (member.second ? &member.first->second : nullptr);
+}
+
+bool JsonParser::read_snapshot(Json& root) {
+	if (size_t(end - cur) < sizeof(snapshot_magic) + 1
+		|| std::memcmp(cur, snapshot_magic, sizeof(snapshot_magic)) != 0)
+		return (set_error("not a binary snapshot"));
+	if (cur[sizeof(snapshot_magic)] != snapshot_version)
+		return (set_error("unsupported binary snapshot version"));
+	cur += sizeof(snapshot_magic) + 1;
+
+	// every count is checked against the bytes left, so a bad snapshot can't make us reserve much
+	uint64_t			n;
+	std::vector<Key>	table;
+	if (!read_varint(cur, end, n) || n > uint64_t(end - cur))
+		return (set_error("truncated binary snapshot"));
+	table.reserve(n);
+	for (size_t count = n; count > 0; --count) {
+		if (!read_varint(cur, end, n) || n > uint64_t(end - cur))
+			return (set_error("truncated binary snapshot"));
+		if (intern_keys)
+			table.push_back(keys.intern(cur, n));
+		else
+			table.emplace_back(StringRef(cur, n), arena);
+		cur += n;
+	}
+
+	std::vector<OpenContainer>	open;
+	OpenContainer*				parent = nullptr;
+	bool						views = use_string_views && arena != nullptr;
+
+	while (true) {
+		// (open may grow below, so parent isn't used after the value)
+		Key const*	key = nullptr;
+		if (parent != nullptr)
+			--parent->left;
+		if (parent != nullptr && parent->members != nullptr) {
+			if (!read_varint(cur, end, n))
+				return (set_error("truncated binary snapshot"));
+			if (n >= table.size())
+				return (set_error("bad binary snapshot, key number out of range"));
+			key = &table[n];
+		}
+
+		if (cur == end)
+			return (set_error("truncated binary snapshot"));
+		Json*	placed;
+		switch (*cur++) {
+			case 'n' :
+				placed = place(root, parent, key, Json());
+				break ;
+			case 't' :
+			case 'f' :
+				placed = place(root, parent, key, cur[-1] == 't');
+				break ;
+			case 'l' :
+				if (!read_varint(cur, end, n))
+					return (set_error("truncated binary snapshot"));
+				placed = place(root, parent, key, Json::number_int((n >> 1) ^ (0 - (n & 1))));
+				break ;
+			case 'd' : {
+				if (end - cur < 8)
+					return (set_error("truncated binary snapshot"));
+				uint64_t	bits = 0;
+				for (int i = 0; i < 8; ++i)
+					bits |= uint64_t(static_cast<unsigned char>(cur[i])) << (i * 8);
+				cur += 8;
+				Json::number_float	f;
+				std::memcpy(&f, &bits, sizeof(f));
+				placed = place(root, parent, key, f);
+				break ;
+			}
+			case '\"' :
+				if (!read_varint(cur, end, n) || n > uint64_t(end - cur))
+					return (set_error("truncated binary snapshot"));
+				if (views)
+					placed = place(root, parent, key, Json(Json::StringView{cur, size_t(n), arena}));
+				else
+					placed = place(root, parent, key, std::string(cur, n));
+				cur += n;
+				break ;
+			case '[' :
+			case '{' : {
+				bool	object = (cur[-1] == '{');
+				if (open.size() >= max_depth)
+					return (set_error("document too deep, nested more than " + std::to_string(max_depth) + " levels"));
+				if (!read_varint(cur, end, n) || n > uint64_t(end - cur))
+					return (set_error("truncated binary snapshot"));
+				if (object)
+					placed = place(root, parent, key, Json::object(Json::object::allocator_type(arena)));
+				else
+					placed = place(root, parent, key, Json::array(Json::array::allocator_type(arena)));
+				if (placed == nullptr)
+					break ;
+				if (object) {
+					placed->value.as_object.reserve(n);
+					open.push_back(OpenContainer{nullptr, &placed->value.as_object, n});
+				} else {
+					placed->value.as_array.reserve(n);
+					open.push_back(OpenContainer{&placed->value.as_array, nullptr, n});
+				}
+				break ;
+			}
+			default :
+				return (set_error("bad binary snapshot, unknown tag"));
+		}
+		if (placed == nullptr)
+			return (set_error("bad binary snapshot, duplicate key: " + key->str()));
+
+		// the container of the next value
+		while (!open.empty() && open.back().left == 0)
+			open.pop_back();
+		if (open.empty())
+			return (cur == end || set_error("bad binary snapshot, data after the document"));
+		parent = &open.back();
+	}
+}
+
+Json::pointer_t JsonParser::load_binary(void) {
+	if (error)
+		return (Json::null_ptr());
+	if (from_stream && !read_stream()) {
+		return (Json::null_ptr());
+	}
+	reset_index();
+
+	// the parser keeps the arena alive while building, the values keep it alive afterwards
+	arena = new_arena(end - cur);
+	if (intern_keys) {
+		keys.reset(arena);
+	}
+
+	Json::pointer_t	root(new (arena) Json());
+	if (!read_snapshot(*root))
+		root.reset();
+
+	keys.reset(nullptr);
+	if (arena != nullptr) {
+		arena->share();
+		arena->release();
+		arena = nullptr;
+	}
+	if (!root)
+		return (Json::null_ptr());
+	return (root);
+}
+
+} // namespace njson
@@ -0,0 +1,180 @@
+#ifndef NJSON_DOM_BUILDER_H
+# define NJSON_DOM_BUILDER_H
+
+# include <algorithm>
+# include <cstring>
+# include <iterator>
+# include <vector>
+
+# include "njson/njson.h"
+
+namespace njson {
+
+/*
+	Handler that builds the Json tree, used by parse() and by the push
+	parser. Children are stored inline, so a container can only be built
+	once all of its children are known: finished values wait on a stack
+	(object members with their key on a stack of keys) and when the
+	container ends its children are moved off the stacks into it, which
+	allocates the container at its exact size.
+
+	With a KeySchema, keys of the schema are the shared keys of the
+	schema, and its slot is kept with every key on the stack. Members
+	with a schema key are appended to their object without looking for
+	a duplicate key, a stamp per slot tells whether the object already
+	has one.
+*/
+class JsonParser::DomBuilder
+{
+	public:
+		DomBuilder(Arena* arena, KeyPool& keys, bool intern_keys, BuildStacks& stacks)
+		: arena(arena), keys(keys), intern_keys(intern_keys), views(false),
+		input(nullptr), input_end(nullptr), values(stacks.values), members(stacks.members),
+		schema(nullptr), slots(stacks.slots), seen(stacks.seen), stamp(stacks.stamp) {
+			clear();
+		}
+
+		// values of a document that failed keep its arena alive, they don't stay on the stacks
+		~DomBuilder() { clear(); }
+
+		DomBuilder(DomBuilder const& other) = delete;
+		DomBuilder& operator=(DomBuilder const& other) = delete;
+
+		// strings inside [begin, end) become views into the input (needs the arena)
+		void set_input(char const* begin, char const* end) {
+			views = true;
+			input = begin;
+			input_end = end;
+		}
+
+		// keys of the schema are recognized (null for none)
+		// (the stamps only grow, so the stamps of earlier documents never match)
+		void set_schema(KeySchema const* key_schema) {
+			schema = key_schema;
+			if (schema != nullptr && seen.size() < schema->size())
+				seen.resize(schema->size(), 0);
+		}
+
+		bool on_null(void) { values.emplace_back(); return (true); }
+		bool on_bool(bool b) { values.emplace_back(b); return (true); }
+		bool on_int(Json::number_int i) { values.emplace_back(i); return (true); }
+		bool on_double(Json::number_float f) { values.emplace_back(f); return (true); }
+
+		// strings without escapes point straight into the input, decoded strings are copied into the arena
+		bool on_string(StringRef str) {
+			if (views) {
+				char const*	data = str.data();
+				if (data < input || data >= input_end) {
+					char*	copy = static_cast<char*>(arena->allocate(str.size(), 1));
+					std::memcpy(copy, str.data(), str.size());
+					data = copy;
+				}
+				values.push_back(Json(Json::StringView{data, str.size(), arena}));
+				return (true);
+			}
+			values.emplace_back(str.str());
+			NJSON_STAT(if (str.size() > std::string().capacity()) stats_allocation(str.size() + 1));
+			return (true);
+		}
+
+		bool on_key(StringRef str) {
+			if (schema != nullptr) {
+				size_t	slot = schema->find(str);
+				slots.push_back(slot);
+				if (slot != KeySchema::npos) {
+					members.push_back(schema->key(slot));
+					return (true);
+				}
+			}
+			if (intern_keys)
+				members.push_back(keys.intern(str.data(), str.size()));
+			else
+				members.emplace_back(str, arena);
+			return (true);
+		}
+
+		bool on_object_start(void) { return (true); }
+		bool on_array_start(void) { return (true); }
+
+		bool on_object_end(size_t count) {
+			Json::object	object{Json::object::allocator_type(arena)};
+			object.reserve(count);
+			auto	value = values.end() - count;
+			if (schema != nullptr) {
+				add_members(object, count);
+			} else {
+				for (auto key = members.end() - count; key != members.end(); ++key, ++value)
+					object.emplace(std::move(*key), std::move(*value));
+			}
+			members.erase(members.end() - count, members.end());
+			values.erase(values.end() - count, values.end());
+			values.emplace_back(std::move(object));
+			return (true);
+		}
+
+		bool on_array_end(size_t count) {
+			Json::array	array(std::make_move_iterator(values.end() - count),
+				std::make_move_iterator(values.end()), Json::array::allocator_type(arena));
+			values.erase(values.end() - count, values.end());
+			values.emplace_back(std::move(array));
+			return (true);
+		}
+
+		// the last finished top-level value
+		Json take(void) {
+			Json	value(std::move(values.back()));
+			values.pop_back();
+			return (value);
+		}
+
+		// the document as a node in the arena, null if there is none
+		Json::pointer_t release(void) {
+			if (values.empty())
+				return (nullptr);
+			return (Json::pointer_t(new (arena) Json(take())));
+		}
+
+	private:
+		void clear(void) {
+			values.clear();
+			members.clear();
+			slots.clear();
+		}
+
+		// the last count members on the stacks, in an object that is built with the schema
+		void add_members(Json::object& object, size_t count) {
+			if (++stamp == 0) {
+				std::fill(seen.begin(), seen.end(), 0);
+				stamp = 1;
+			}
+			auto	value = values.end() - count;
+			auto	slot = slots.end() - count;
+			for (auto key = members.end() - count; key != members.end(); ++key, ++value, ++slot) {
+				if (*slot == KeySchema::npos) {
+					object.emplace(std::move(*key), std::move(*value));
+				} else if (seen[*slot] != stamp) {
+					seen[*slot] = stamp;
+					object.append(std::move(*key), std::move(*value));
+				}
+			}
+			slots.erase(slots.end() - count, slots.end());
+		}
+
+		Arena*				arena;
+		KeyPool&			keys;
+		bool				intern_keys;
+		bool				views;
+		char const*			input;
+		char const*			input_end;
+		std::vector<Json>&	values;
+		std::vector<Key>&	members;
+
+		KeySchema const*		schema;
+		std::vector<size_t>&	slots;
+		std::vector<uint32_t>&	seen;
+		uint32_t&				stamp;
+};
+
+} // namespace njson
+
+#endif // NJSON_DOM_BUILDER_H
@@ -1,6 +1,7 @@
 #include "njson/njson.h"
+#include "njson/writer.h"
 
-#include <iomanip>
+#include <vector>
 
 namespace njson {
 
@@ -14,6 +15,8 @@ Json::Value::Value() : as_int(0) {}
 Json::Value::Value(Json::array&& _array) : as_array(std::move(_array)) {}
 Json::Value::Value(Json::object&& _object) : as_object(std::move(_object)) {}
 Json::Value::Value(Json::string const& _str) : as_string(_str) {}
+Json::Value::Value(Json::string&& _str) : as_string(std::move(_str)) {}
+Json::Value::Value(Json::StringView _view) : as_view(_view) {}
 Json::Value::Value(Json::number_float _float) : as_float(_float) {}
 Json::Value::Value(Json::number_int _int) : as_int(_int) {}
 Json::Value::Value(bool _bool) : as_bool(_bool) {}
@@ -25,30 +28,180 @@ Json::Value::~Value() {}
 /* -------------------------------------------------------------------------- */
 
 Json::Json(array&& array)
-: type(Type::ARRAY), value(std::move(array)) {};
+: type(Type::ARRAY), is_view(false), value(std::move(array)) {
+	if (Arena* arena = value_arena())
+		arena->retain();
+}
 
 Json::Json(object&& object)
-: type(Type::OBJECT), value(std::move(object)) {};
+: type(Type::OBJECT), is_view(false), value(std::move(object)) {
+	if (Arena* arena = value_arena())
+		arena->retain();
+}
 
-Json::Json() : type(Type::NULL_T) {}
-Json::Json(null_t _null __attribute__((unused))) : type(Type::NULL_T) {}
-Json::Json(string const& str) : type(Type::STRING), value(str) {}
-Json::Json(const char* str) : type(Type::STRING), value(string {str}) {}
+Json::Json() : type(Type::NULL_T), is_view(false) {}
+Json::Json(null_t _null __attribute__((unused))) : type(Type::NULL_T), is_view(false) {}
+Json::Json(string const& str) : type(Type::STRING), is_view(false), value(str) {}
+Json::Json(string&& str) : type(Type::STRING), is_view(false), value(std::move(str)) {}
+Json::Json(const char* str) : type(Type::STRING), is_view(false), value(string {str}) {}
+Json::Json(StringView view) : type(Type::STRING), is_view(true), value(view) {
+	if (view.arena != nullptr)
+		view.arena->retain();
+}
 // Json::Json(number_float f) : type(Type::NUMBER_FLOAT) , value(f) {}
 // Json::Json(number_int i) : type(Type::NUMBER_INT) , value(i) {}
-Json::Json(bool b) : type(Type::BOOL) , value(b) {}
+Json::Json(bool b) : type(Type::BOOL), is_view(false), value(b) {}
+
+/* -------------------------------------------------------------------------- */
+/*                               Node Allocation                              */
+/* -------------------------------------------------------------------------- */
+
+//	every node is preceded by the arena it was allocated from (null for the heap)
+static const size_t	node_header = sizeof(Arena*) > alignof(Json) ? sizeof(Arena*) : alignof(Json);
+
+void* Json::operator new(size_t size, Arena* arena) {
+	char*	p;
+	if (arena == nullptr) {
+		p = static_cast<char*>(::operator new(node_header + size));
+		NJSON_STAT(stats_allocation(node_header + size));
+	} else {
+		p = static_cast<char*>(arena->allocate(node_header + size, alignof(Json)));
+		arena->retain();
+	}
+	*reinterpret_cast<Arena**>(p) = arena;
+	return (p + node_header);
+}
+
+void Json::operator delete(void* ptr) {
+	if (ptr == nullptr)
+		return ;
+	char*	p = static_cast<char*>(ptr) - node_header;
+	Arena*	arena = *reinterpret_cast<Arena**>(p);
+	if (arena == nullptr)
+		::operator delete(p);
+	else
+		arena->release();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Move, Copy, Destruction                          */
+/* -------------------------------------------------------------------------- */
+
+//	the reference to the arena moves along with the value
+void Json::move_value(Json& other) {
+	switch (type) {
+		case Type::ARRAY: new (&value.as_array) array(std::move(other.value.as_array)); break ;
+		case Type::OBJECT: new (&value.as_object) object(std::move(other.value.as_object)); break ;
+		case Type::STRING: new (&value.as_string) string(std::move(other.value.as_string)); break ;
+		default: break ;
+	}
+	other.destroy_value();
+}
+
+//	other can be part of this value (node = std::move(node.find("child"))), so it's moved out first
+Json& Json::operator=(Json&& other) noexcept {
+	if (this != &other) {
+		Json	tmp(std::move(other));
+		this->~Json();
+		::new (this) Json(std::move(tmp));
+	}
+	return (*this);
+}
+
+/*
+	Destroying a container destroys its children, which recurses once per
+	level. Once the destruction of a tree has used max_destroy_stack bytes
+	of stack, the containers it reaches are moved to a list instead, and
+	the outermost destruction destroys them from it, so a tree of any
+	depth is destroyed with a bounded stack. (The stack grows down, where
+	it doesn't every deep container is deferred, which is only slower.)
+*/
+static const size_t						max_destroy_stack = size_t(256) << 10;
+static thread_local std::vector<Json>*	deferred = nullptr;
+static thread_local char const*			destroy_base = nullptr;
+
+//	the outermost container being destroyed, the deferred ones can defer their own containers again
+static void	destroy_tree(Json& json) {
+	std::vector<Json>	deep;
+	deferred = &deep;
+	destroy_base = static_cast<char const*>(__builtin_frame_address(0));
+	{
+		Json	value(std::move(json));
+	}
+	while (!deep.empty()) {
+		Json	value(std::move(deep.back()));
+		deep.pop_back();
+	}
+	deferred = nullptr;
+}
+
+//	a container released outside of any destruction, or past max_destroy_stack bytes into one
+__attribute__((noinline))
+static void	release_deep(Json& json) {
+	if (deferred == nullptr)
+		destroy_tree(json);
+	else
+		deferred->push_back(std::move(json));
+}
+
+void Json::release_value(void) {
+	if (type != Type::STRING && (deferred == nullptr
+			|| size_t(destroy_base - static_cast<char const*>(__builtin_frame_address(0))) > max_destroy_stack)) {
+		release_deep(*this);
+		return ;
+	}
+	Arena*	arena = value_arena();
+	destroy_value();
+	if (arena != nullptr)
+		arena->release();
+}
 
-//	Destructor
-Json::~Json() {
+void Json::destroy_value(void) {
 	//	Based on the type, destructor will act differently
 	switch (this->type) {
 		case Type::ARRAY: value.as_array.~array(); break ;
 		case Type::OBJECT: value.as_object.~object(); break ;
-		case Type::STRING: value.as_string.~string(); break ;
+		case Type::STRING: if (!is_view) value.as_string.~string(); break ;
 		default: break ;
 	}
 }
 
+Arena* Json::value_arena(void) const {
+	switch (this->type) {
+		case Type::ARRAY: return (value.as_array.get_allocator().get_arena());
+		case Type::OBJECT: return (value.as_object.get_allocator().get_arena());
+		case Type::STRING: return (is_view ? value.as_view.arena : nullptr);
+		default: return (nullptr);
+	}
+}
+
+Json Json::clone(void) const {
+	switch (this->type) {
+		case Type::ARRAY: {
+			array	copy;
+			copy.reserve(value.as_array.size());
+			for (Json const& element : value.as_array)
+				copy.push_back(element.clone());
+			return (Json(std::move(copy)));
+		}
+		case Type::OBJECT: {
+			object	copy;
+			copy.reserve(value.as_object.size());
+			for (auto const& member : value.as_object) {
+				// keys stored in the document's arena are copied, heap keys are shared
+				Key	key = member.first.get_arena() ? Key(member.first.ref()) : member.first;
+				copy.emplace(key, member.second.clone());
+			}
+			return (Json(std::move(copy)));
+		}
+		case Type::STRING: return (Json(get_string_ref().str()));
+		case Type::NUMBER_FLOAT: return (Json(value.as_float));
+		case Type::NUMBER_INT: return (Json(value.as_int));
+		case Type::BOOL: return (Json(value.as_bool));
+		default: return (Json());
+	}
+}
+
 /* -------------------------------------------------------------------------- */
 /*                                 check_type                                 */
 /* -------------------------------------------------------------------------- */
@@ -106,6 +259,7 @@ template<> Json::object& Json::get<Json::object>(void) {
 
 template<> Json::string& Json::get<Json::string>(void) {
 	check_type<std::string>();
+	own_string();
 	return value.as_string;
 }
 
@@ -138,6 +292,8 @@ template<> Json::object const& Json::get<Json::object>(void) const {
 
 template<> Json::string const& Json::get<Json::string>(void) const {
 	check_type<string>();
+	if (is_view)
+		throw(json_exception("string points into the input, read it with get_string() or get_string_ref()"));
 	return value.as_string;
 }
 
@@ -156,6 +312,28 @@ template<> bool const& Json::get<bool>(void) const {
 	return value.as_bool;
 }
 
+/* -------------------------------------------------------------------------- */
+/*                                String Views                                */
+/* -------------------------------------------------------------------------- */
+
+StringRef Json::get_string_ref(void) const {
+	check_type<string>();
+	if (is_view)
+		return (StringRef(value.as_view.data, value.as_view.size));
+	return (StringRef(value.as_string));
+}
+
+//	views are complete strings (escapes are decoded while parsing), so reading one never changes the node
+void Json::own_string(void) {
+	if (!is_view)
+		return ;
+	StringView	view = value.as_view;
+	new (&value.as_string) string(view.data, view.size);
+	is_view = false;
+	if (view.arena != nullptr)
+		view.arena->release();
+}
+
 /* -------------------------------------------------------------------------- */
 /*                                     is                                     */
 /* -------------------------------------------------------------------------- */
@@ -210,38 +388,61 @@ std::string Json::get_type_string(Type type) {
 /*                              Add to map/vector                             */
 /* -------------------------------------------------------------------------- */
 
+void Json::add_to_object(const key_t& key, Json&& json) {
+	if (get_type() != Type::OBJECT) return ;
+	get<object>().emplace(key, std::move(json));
+}
+
 void Json::add_to_object(const key_t& key, Json* json) {
-	if (get_type() != Type::OBJECT)
-		return ;
-	get<object>().emplace(key, pointer_t {json});
+	add_to_object(key, pointer_t {json});
 }
 
 void Json::add_to_object(const key_t& key, Json::pointer_t json) {
-	if (get_type() != Type::OBJECT) return ;
-	get<object>().emplace(key, std::move(json));
+	if (get_type() != Type::OBJECT || !json) return ;
+	get<object>().emplace(key, std::move(*json));
 }
 
-void Json::add_to_array(Json* json) {
+void Json::add_to_array(Json&& json) {
 	if (get_type() != Type::ARRAY) return ;
-	get<array>().emplace_back(pointer_t {json});
+	get<array>().push_back(std::move(json));
+}
+
+void Json::add_to_array(Json* json) {
+	add_to_array(pointer_t {json});
 }
 
 void Json::add_to_array(Json::pointer_t json) {
-	if (get_type() != Type::ARRAY) return ;
-	get<array>().emplace_back(std::move(json));
+	if (get_type() != Type::ARRAY || !json) return ;
+	get<array>().push_back(std::move(*json));
 }
 
 /* -------------------------------------------------------------------------- */
 /*                                    Find                                    */
 /* -------------------------------------------------------------------------- */
 
+Json& Json::missing_ref(void) {
+	static thread_local Json	null_node;
+	null_node = Json();
+	return (null_node);
+}
+
 //	Not sure about this, but it is easy to use.
 //	returns an null type Json reference if key can't be found.
-Json::pointer_t& Json::find(const key_t& key) {
+Json& Json::find(StringRef key) {
 	if (get_type() != Type::OBJECT)
-		return (null_ref());
+		return (missing_ref());
 	auto& obj = get<object>();
 	auto it = obj.find(key);
+	if (it == obj.end())
+		return (missing_ref());
+	return (it->second);
+}
+
+Json const& Json::find(StringRef key) const {
+	if (get_type() != Type::OBJECT)
+		return (null_ref());
+	auto const& obj = get<object>();
+	auto it = obj.find(key);
 	if (it == obj.end())
 		return (null_ref());
 	return (it->second);
@@ -252,95 +453,19 @@ Json::pointer_t& Json::find(const key_t& key) {
 /* -------------------------------------------------------------------------- */
 
 void Json::print(std::ostream& out, bool pretty) const {
-	print_impl(0, out, pretty);
+	print_impl(out, pretty);
 	out << std::endl;
 }
 
-void Json::print_depth(size_t depth, std::ostream& out) const {
-	while (depth-- > 0) {
-		out << indentation_string;
-	}
-}
-
-void Json::print_impl(size_t depth, std::ostream& out, bool pretty) const {
-	switch (get_type()) {
-		case Type::NUMBER_FLOAT :
-			out << std::setprecision(15) << get<number_float>();
-			break;
-		case Type::NUMBER_INT :
-			out << get<number_int>();
-			break;
-		case Type::BOOL :
-			if (get<bool>())
-				out << "true";
-			else
-				out << "false";
-			break;
-		case Type::STRING :
-			out << '"' << get<string>() << '"';
-			break;
-		case Type::OBJECT :
-			print_object(depth, out, pretty);
-			break;
-		case Type::ARRAY :
-			print_array(depth, out, pretty);
-			break;
-		case Type::NULL_T :
-			out << "null";
-			break;
-		default:
-			out << "UNKNOWN_TYPE";
-	}
-}
-
-void	Json::print_object(size_t depth, std::ostream& out, bool pretty) const {
-	out << '{';
-	if (value.as_object.size() == 0)
-	{
-		out << '}';
-		return ;
-	}
-	if (pretty) out << '\n';
-	for (auto it = value.as_object.begin(); it != value.as_object.end();)
-	{
-		auto const& pair = *it;
-		if (pretty)
-			print_depth(depth + 1, out);
-		out << '"' << pair.first << "\": ";
-		pair.second->print_impl(depth + 1, out, pretty);
-		++it;
-		if (it != value.as_object.end())
-			out << ',';
-		if (pretty) out << '\n'; else out << ' ';
-	}
-	if (pretty) print_depth(depth, out);
-	out << '}';
+void Json::print_impl(std::ostream& out, bool pretty) const {
+	JsonWriter	writer(out, pretty);
+	writer.write(*this);
 }
 
-void	Json::print_array(size_t depth, std::ostream& out, bool pretty) const
-{
-	out << "[";
-	for (size_t i = 0; i < value.as_array.size(); ++i)
-	{
-		// if (pretty && value.array[i]->get_type() == Type::OBJECT)
-		// 	print_depth(depth, out, pretty);
-		if (pretty)
-		{
-			out << '\n';
-			print_depth(depth + 1, out);
-		}
-		value.as_array[i]->print_impl(depth + 1, out, pretty);
-		if (i < value.as_array.size() - 1)
-		{
-			out << ", ";
-		}
-	}
-	if (pretty)
-	{
-		out << '\n';
-		print_depth(depth, out);
-	}
-	out << "]";
+std::string Json::to_string(bool pretty) const {
+	JsonWriter	writer(pretty);
+	writer.write(*this);
+	return (writer.release());
 }
 
 }	//	namespace njson
@@ -0,0 +1,268 @@
+#include "njson/json_lines.h"
+#include "njson/mapped_file.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                Construction                                */
+/* -------------------------------------------------------------------------- */
+
+static const size_t	default_batch_size = 256 * 1024;
+
+JsonLinesReader::JsonLinesReader(char const* data, size_t length)
+: error(false), errmsg(""), data(data), length(length),
+threads(0), ordered(true), batch_size(default_batch_size), use_arena(true), intern_keys(true) {}
+
+JsonLinesReader::JsonLinesReader(std::istream& stream) : JsonLinesReader(nullptr, 0) {
+	if (!stream) {
+		error = true;
+		errmsg = "bad input stream";
+		return ;
+	}
+	char	chunk[1 << 16];
+	while (stream) {
+		stream.read(chunk, sizeof(chunk));
+		buffer.append(chunk, stream.gcount());
+	}
+	data = buffer.data();
+	length = buffer.size();
+}
+
+JsonLinesReader::JsonLinesReader(std::string const& path) : JsonLinesReader(nullptr, 0) {
+	mapping = std::make_shared<MappedFile>(path);
+	if (mapping->is_open()) {
+		data = mapping->data();
+		length = mapping->size();
+		return ;
+	}
+
+	// not mappable, read it as a stream instead
+	mapping.reset();
+	std::ifstream	file(path, std::ios::binary);
+	if (!file) {
+		error = true;
+		errmsg = "bad input stream";
+		return ;
+	}
+	std::stringstream	ss;
+	ss << file.rdbuf();
+	buffer = ss.str();
+	data = buffer.data();
+	length = buffer.size();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Batches                                  */
+/* -------------------------------------------------------------------------- */
+
+// whole lines [begin, end), parsed by one worker
+struct JsonLinesReader::Batch {
+	char const*			begin;
+	char const*			end;
+	size_t				first_line;
+	std::vector<Record>	records;
+	bool				done;
+};
+
+static bool	is_blank(char const* p, char const* end) {
+	for (; p < end; ++p) {
+		if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\v' && *p != '\f')
+			return (false);
+	}
+	return (true);
+}
+
+void JsonLinesReader::parse_batch(Batch& batch, JsonParser& parser) const {
+	size_t		line = batch.first_line;
+	char const*	p = batch.begin;
+
+	while (p < batch.end) {
+		char const*	eol = static_cast<char const*>(std::memchr(p, '\n', batch.end - p));
+		if (eol == nullptr)
+			eol = batch.end;
+		if (!is_blank(p, eol)) {
+			parser.open(p, eol - p);
+			Record	record;
+			record.line = line;
+			record.json = parser.parse();
+			if (parser.has_error())
+				record.error = parser.get_error_msg();
+			batch.records.push_back(std::move(record));
+		}
+		p = eol + 1;
+		++line;
+	}
+}
+
+// cuts the input after the first newline past every batch_size bytes, counting the lines
+void JsonLinesReader::cut_batches(std::vector<Batch>& batches) const {
+	char const*	end = data + length;
+	char const*	p = data;
+	size_t		line = 1;
+
+	while (p < end) {
+		char const*	cut = (size_t(end - p) > batch_size) ? p + batch_size : end;
+		char const*	eol = static_cast<char const*>(std::memchr(cut - 1, '\n', end - cut + 1));
+		cut = (eol == nullptr) ? end : eol + 1;
+
+		batches.push_back(Batch{p, cut, line, {}, false});
+		for (char const* q = p; (q = static_cast<char const*>(std::memchr(q, '\n', cut - q))) != nullptr; ++q)
+			++line;
+		p = cut;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Worker Pool                                */
+/* -------------------------------------------------------------------------- */
+
+/*
+	Workers claim the batches in input order. A worker only starts a
+	batch while fewer than `window` batches are claimed but not yet
+	delivered. The destructor stops and joins the workers, also when the
+	callback throws.
+*/
+class JsonLinesReader::Pool
+{
+	public:
+		Pool(JsonLinesReader const& reader, std::vector<Batch>& batches, size_t threads, bool ordered)
+		: reader(reader), batches(batches), ordered(ordered), window(threads * 4),
+		claimed(0), delivered(0), stop(false) {
+			for (size_t i = 0; i < threads; ++i)
+				workers.emplace_back(&Pool::work, this);
+		}
+
+		~Pool() {
+			{
+				std::lock_guard<std::mutex>	lock(mutex);
+				stop = true;
+			}
+			work_cv.notify_all();
+			for (std::thread& worker : workers)
+				worker.join();
+		}
+
+		// waits for the next batch to deliver, null when all batches are delivered
+		Batch* next(void) {
+			std::unique_lock<std::mutex>	lock(mutex);
+			if (delivered == batches.size())
+				return (nullptr);
+			if (ordered) {
+				Batch&	batch = batches[delivered];
+				done_cv.wait(lock, [&batch]() { return batch.done; });
+				return (&batch);
+			}
+			done_cv.wait(lock, [this]() { return !finished.empty(); });
+			Batch*	batch = finished.back();
+			finished.pop_back();
+			return (batch);
+		}
+
+		// the batch was delivered, its records can be freed
+		void release(Batch* batch) {
+			std::vector<Record>().swap(batch->records);
+			{
+				std::lock_guard<std::mutex>	lock(mutex);
+				++delivered;
+			}
+			work_cv.notify_one();
+		}
+
+	private:
+		void work(void) {
+			JsonParser	parser;
+			parser.set_use_arena(reader.use_arena);
+			parser.set_intern_keys(reader.intern_keys);
+			parser.set_key_schema(reader.key_schema);
+
+			std::unique_lock<std::mutex>	lock(mutex);
+			while (true) {
+				work_cv.wait(lock, [this]() {
+					return stop || claimed == batches.size() || claimed - delivered < window;
+				});
+				if (stop || claimed == batches.size())
+					return ;
+				Batch&	batch = batches[claimed++];
+
+				lock.unlock();
+				reader.parse_batch(batch, parser);
+				lock.lock();
+
+				batch.done = true;
+				if (!ordered)
+					finished.push_back(&batch);
+				done_cv.notify_one();
+			}
+		}
+
+		JsonLinesReader const&		reader;
+		std::vector<Batch>&			batches;
+		bool						ordered;
+		size_t						window;
+
+		std::mutex					mutex;
+		std::condition_variable		work_cv;	// a worker can claim a batch
+		std::condition_variable		done_cv;	// a batch was parsed
+		size_t						claimed;
+		size_t						delivered;
+		bool						stop;
+		std::vector<Batch*>			finished;	// parsed, not delivered yet (unordered)
+		std::vector<std::thread>	workers;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Reading                                  */
+/* -------------------------------------------------------------------------- */
+
+size_t JsonLinesReader::read(callback_t const& callback) {
+	if (error)
+		return (0);
+
+	std::vector<Batch>	batches;
+	cut_batches(batches);
+
+	size_t	n = threads;
+	if (n == 0)
+		n = std::thread::hardware_concurrency();
+	if (n > batches.size())
+		n = batches.size();
+
+	size_t	count = 0;
+	if (n <= 1) {
+		JsonParser	parser;
+		parser.set_use_arena(use_arena);
+		parser.set_intern_keys(intern_keys);
+		parser.set_key_schema(key_schema);
+		for (Batch& batch : batches) {
+			parse_batch(batch, parser);
+			for (Record& record : batch.records) {
+				++count;
+				if (!callback(record))
+					return (count);
+			}
+			std::vector<Record>().swap(batch.records);
+		}
+		return (count);
+	}
+
+	Pool	pool(*this, batches, n, ordered);
+	while (Batch* batch = pool.next()) {
+		for (Record& record : batch->records) {
+			++count;
+			if (!callback(record))
+				return (count);
+		}
+		pool.release(batch);
+	}
+	return (count);
+}
+
+} // namespace njson
@@ -0,0 +1,200 @@
+#include "njson/key.h"
+
+#include <algorithm>
+#include <new>
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                    Keys                                    */
+/* -------------------------------------------------------------------------- */
+
+uint32_t Key::hash(char const* data, size_t size) {
+	uint32_t	h = 2166136261u;
+	for (size_t i = 0; i < size; ++i) {
+		h ^= static_cast<unsigned char>(data[i]);
+		h *= 16777619u;
+	}
+	return (h);
+}
+
+// the characters are stored right after the representation
+Key::Rep* Key::make_rep(char const* str, size_t len, Arena* arena) {
+	size_t	bytes = sizeof(Rep) + len + 1;
+	void*	mem;
+	if (arena != nullptr) {
+		mem = arena->allocate(bytes, alignof(Rep));
+		arena->retain();
+	} else {
+		mem = ::operator new(bytes);
+		NJSON_STAT(stats_allocation(bytes));
+	}
+
+	Rep*	rep = new (mem) Rep;
+	rep->arena = arena;
+	rep->refs.store(1, std::memory_order_relaxed);
+	rep->size = uint32_t(len);
+	rep->hash = hash(str, len);
+	rep->interned = false;
+	std::memcpy(rep->chars(), str, len);
+	rep->chars()[len] = '\0';
+	return (rep);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Key pool                                  */
+/* -------------------------------------------------------------------------- */
+
+static const size_t	initial_pool_slots = 64;
+
+void KeyPool::reset(Arena* new_arena) {
+	if (arena != nullptr)
+		arena->release();
+	arena = new_arena;
+	if (arena != nullptr)
+		arena->retain();
+	slots.clear();
+	count = 0;
+}
+
+// open addressing with linear probing, kept at most half full
+Key KeyPool::intern(char const* str, size_t len) {
+	if (arena == nullptr) {
+		arena = new Arena();
+		arena->retain();
+	}
+	if ((count + 1) * 2 > slots.size())
+		grow();
+
+	uint32_t	h = Key::hash(str, len);
+	size_t		mask = slots.size() - 1;
+	size_t		i = h & mask;
+	while (Key::Rep* rep = slots[i]) {
+		if (rep->hash == h && rep->size == len && std::memcmp(rep->chars(), str, len) == 0) {
+			arena->retain();
+			return (Key(rep));
+		}
+		i = (i + 1) & mask;
+	}
+
+	Key::Rep*	rep = Key::make_rep(str, len, arena);
+	rep->interned = true;
+	slots[i] = rep;
+	++count;
+	return (Key(rep));
+}
+
+void KeyPool::grow(void) {
+	std::vector<Key::Rep*>	old;
+	old.swap(slots);
+	slots.assign(old.empty() ? initial_pool_slots : old.size() * 2, nullptr);
+
+	size_t	mask = slots.size() - 1;
+	for (Key::Rep* rep : old) {
+		if (rep == nullptr)
+			continue ;
+		size_t	i = rep->hash & mask;
+		while (slots[i] != nullptr)
+			i = (i + 1) & mask;
+		slots[i] = rep;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*                                 Key schema                                 */
+/* -------------------------------------------------------------------------- */
+
+KeySchema::KeySchema(std::initializer_list<StringRef> keys)
+: multiplier(1), shift(63), whole_keys(false) {
+	for (StringRef key : keys)
+		add(key);
+	build();
+}
+
+KeySchema::KeySchema(std::vector<std::string> const& keys)
+: multiplier(1), shift(63), whole_keys(false) {
+	for (std::string const& key : keys)
+		add(key);
+	build();
+}
+
+void KeySchema::add(StringRef key) {
+	for (Key const& k : keys)
+		if (k.ref() == key)
+			return ;
+	keys.emplace_back(key);
+}
+
+// tables of 2 to 16 slots per key, a few dozen random multipliers per size
+static const size_t	schema_min_bits = 1;
+static const size_t	schema_max_load = 16;
+static const size_t	schema_attempts = 64;
+
+/*
+	Looks for a multiplier that sends every key to its own slot (a
+	perfect hash), first with the sampled fingerprints. Keys that share
+	a fingerprint can't be separated by any multiplier, then the whole
+	keys are used. If no table works the one that places the most keys
+	is kept, the keys it couldn't place aren't recognized.
+*/
+void KeySchema::build(void) {
+	std::vector<uint64_t>	prints;
+	for (Key const& key : keys)
+		prints.push_back(fingerprint(key.data(), key.size()));
+	std::sort(prints.begin(), prints.end());
+	whole_keys = std::adjacent_find(prints.begin(), prints.end()) != prints.end();
+
+	size_t	min_bits = schema_min_bits;
+	while ((size_t(1) << min_bits) < keys.size() * 2)
+		++min_bits;
+	size_t	max_bits = min_bits;
+	while ((size_t(1) << max_bits) < keys.size() * schema_max_load)
+		++max_bits;
+
+	uint64_t	random = 0x2545F4914F6CDD1Dull;
+	size_t		best = npos;
+	size_t		best_bits = min_bits;
+	uint64_t	best_multiplier = 1;
+	for (size_t bits = min_bits; bits <= max_bits; ++bits) {
+		for (size_t attempt = 0; attempt < schema_attempts; ++attempt) {
+			random ^= random << 13;
+			random ^= random >> 7;
+			random ^= random << 17;
+			multiplier = random | 1;
+			size_t	missed = place(bits);
+			if (missed == 0)
+				return ;
+			if (missed < best) {
+				best = missed;
+				best_bits = bits;
+				best_multiplier = multiplier;
+			}
+		}
+	}
+	multiplier = best_multiplier;
+	place(best_bits);
+}
+
+// fills a table of 2^bits slots, returns the number of keys that found their slot taken
+size_t KeySchema::place(size_t bits) {
+	Entry	empty = {nullptr, uint32_t(-1), uint32_t(npos)};
+	table.assign(size_t(1) << bits, empty);
+	shift = unsigned(64 - bits);
+
+	size_t	missed = 0;
+	for (size_t slot = 0; slot < keys.size(); ++slot) {
+		Key const&	key = keys[slot];
+		Entry&		entry = table[(fingerprint(key.data(), key.size()) * multiplier) >> shift];
+		if (entry.chars != nullptr) {
+			++missed;
+			continue ;
+		}
+		entry.chars = key.data();
+		entry.size = uint32_t(key.size());
+		entry.slot = uint32_t(slot);
+	}
+	return (missed);
+}
+
+} // namespace njson
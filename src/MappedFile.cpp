@@ -0,0 +1,59 @@
+#include "njson/mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+# define NJSON_HAS_MMAP 1
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace njson {
+
+#ifdef NJSON_HAS_MMAP
+
+MappedFile::MappedFile(std::string const& path) : addr(nullptr), length(0), open(false) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return ;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(fd);
+		return ;
+	}
+
+	length = size_t(st.st_size);
+	// mmap() doesn't accept an empty range, an empty file just has no data
+	if (length > 0) {
+		void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) {
+			length = 0;
+			::close(fd);
+			return ;
+		}
+		madvise(p, length, MADV_SEQUENTIAL);
+		madvise(p, length, MADV_WILLNEED);
+		addr = static_cast<char const*>(p);
+	}
+
+	// the mapping stays valid after closing the descriptor
+	::close(fd);
+	open = true;
+}
+
+MappedFile::~MappedFile() {
+	if (addr != nullptr)
+		munmap(const_cast<char*>(addr), length);
+}
+
+#else
+
+MappedFile::MappedFile(std::string const&)
+: addr(nullptr), length(0), open(false) {}
+
+MappedFile::~MappedFile() {}
+
+#endif
+
+} // namespace njson
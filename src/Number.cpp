@@ -0,0 +1,570 @@
+#include "njson/number.h"
+#include "PowerTable.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace njson {
+
+static inline bool	is_digit(char c) {
+	return (c >= '0' && c <= '9');
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Eisel-Lemire                               */
+/* -------------------------------------------------------------------------- */
+
+//	binary64 layout
+static const int		mantissa_bits = 52;
+static const int		minimum_exponent = -1023;
+static const int		infinite_power = 0x7FF;
+
+//	exactly representable powers of ten for the fast path
+static const double		exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline void	full_multiplication(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low) {
+	unsigned __int128	r = (unsigned __int128)a * b;
+	high = uint64_t(r >> 64);
+	low = uint64_t(r);
+}
+
+//	floor(log2(10^q)) + 63, valid for the table range
+static inline int	power_of_two(int q) {
+	return (((152170 + 65536) * q) >> 16) + 63;
+}
+
+/*
+	w * 10^q rounded to the nearest double, as biased exponent and mantissa
+	(w != 0, q inside the table). This is the Eisel-Lemire algorithm: the
+	product with a 128-bit approximation of 5^q always has enough correct
+	bits to round a 64-bit w exactly.
+*/
+static void	compute_float(int q, uint64_t w, uint64_t& mantissa, int& power2) {
+	int		lz = __builtin_clzll(w);
+	w <<= lz;
+
+	int			index = 2 * (q - smallest_power_of_five);
+	uint64_t	high, low;
+	full_multiplication(w, power_of_five_128[index], high, low);
+
+	// not enough bits known yet, add the contribution of the lower table word
+	const uint64_t	precision_mask = uint64_t(0xFFFFFFFFFFFFFFFF) >> (mantissa_bits + 3);
+	if ((high & precision_mask) == precision_mask) {
+		uint64_t	high2, low2;
+		full_multiplication(w, power_of_five_128[index + 1], high2, low2);
+		low += high2;
+		if (high2 > low)
+			++high;
+	}
+
+	int	upperbit = int(high >> 63);
+	int	shift = upperbit + 64 - mantissa_bits - 3;
+	mantissa = high >> shift;
+	power2 = power_of_two(q) + upperbit - lz - minimum_exponent;
+
+	// subnormal
+	if (power2 <= 0) {
+		if (-power2 + 1 >= 64) {
+			mantissa = 0;
+			power2 = 0;
+			return ;
+		}
+		mantissa >>= -power2 + 1;
+		mantissa += (mantissa & 1);
+		mantissa >>= 1;
+		power2 = (mantissa < (uint64_t(1) << mantissa_bits)) ? 0 : 1;
+		return ;
+	}
+
+	// exactly halfway: round to even instead of up
+	if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1) {
+		if ((mantissa << shift) == high)
+			mantissa &= ~uint64_t(1);
+	}
+
+	mantissa += (mantissa & 1);
+	mantissa >>= 1;
+	if (mantissa >= (uint64_t(2) << mantissa_bits)) {
+		mantissa = (uint64_t(1) << mantissa_bits);
+		++power2;
+	}
+	mantissa &= ~(uint64_t(1) << mantissa_bits);
+	if (power2 >= infinite_power) {
+		power2 = infinite_power;
+		mantissa = 0;
+	}
+}
+
+static inline double	to_double(bool negative, uint64_t mantissa, int power2) {
+	uint64_t	bits = mantissa | (uint64_t(power2) << mantissa_bits);
+	if (negative)
+		bits |= uint64_t(1) << 63;
+	double	d;
+	std::memcpy(&d, &bits, sizeof(d));
+	return (d);
+}
+
+//	correctly rounded but slow, only for inputs with more than 19 digits that Eisel-Lemire can't settle
+static bool	fallback_strtod(char const* begin, char const* end, double& f) {
+	std::istringstream	in(std::string(begin, end));
+	in.imbue(std::locale::classic());
+	in >> f;
+	return (!in.fail());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+bool	parse_number(char const*& p, char const* end, int64_t& i, double& f, bool& is_float) {
+	char const*	start = p;
+	char const*	cur = p;
+
+	bool	negative = (cur < end && *cur == '-');
+	if (negative)
+		++cur;
+
+	// integer part: a single zero or digits without leading zeros
+	char const*	int_begin = cur;
+	if (cur == end || !is_digit(*cur))
+		return (false);
+	if (*cur == '0') {
+		++cur;
+	} else {
+		while (cur < end && is_digit(*cur))
+			++cur;
+	}
+	char const*	int_end = cur;
+
+	// fraction
+	char const*	frac_begin = cur;
+	char const*	frac_end = cur;
+	if (cur < end && *cur == '.') {
+		frac_begin = ++cur;
+		while (cur < end && is_digit(*cur))
+			++cur;
+		frac_end = cur;
+		if (frac_begin == frac_end)
+			return (false);
+	}
+
+	// exponent, clamped far outside the range of a double so it can't overflow
+	int64_t	exponent = 0;
+	bool	has_exponent = false;
+	if (cur < end && (*cur == 'e' || *cur == 'E')) {
+		has_exponent = true;
+		++cur;
+		bool	exp_negative = false;
+		if (cur < end && (*cur == '+' || *cur == '-')) {
+			exp_negative = (*cur == '-');
+			++cur;
+		}
+		if (cur == end || !is_digit(*cur))
+			return (false);
+		while (cur < end && is_digit(*cur)) {
+			if (exponent < 100000)
+				exponent = exponent * 10 + (*cur - '0');
+			++cur;
+		}
+		if (exp_negative)
+			exponent = -exponent;
+	}
+
+	is_float = (frac_begin != frac_end || has_exponent);
+
+	// integers that fit stay integers
+	if (!is_float) {
+		uint64_t	value = 0;
+		bool		overflow = (int_end - int_begin > 20);
+		for (char const* d = int_begin; d < int_end && !overflow; ++d) {
+			overflow = __builtin_mul_overflow(value, uint64_t(10), &value)
+				|| __builtin_add_overflow(value, uint64_t(*d - '0'), &value);
+		}
+		uint64_t	limit = uint64_t(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+		if (!overflow && value <= limit) {
+			i = negative ? int64_t(0 - value) : int64_t(value);
+			p = cur;
+			return (true);
+		}
+		is_float = true;
+	}
+
+	// up to 19 significant digits fit in w, the rest only affects rounding
+	uint64_t	w = 0;
+	int			taken = 0;
+	int64_t		q = exponent;
+	bool		truncated = false;
+	bool		leading = true;
+	for (char const* d = int_begin; d < int_end; ++d) {
+		if (leading && *d == '0')
+			continue ;
+		leading = false;
+		if (taken < 19) {
+			w = w * 10 + uint64_t(*d - '0');
+			++taken;
+		} else {
+			// dropped integer digits still scale the value
+			++q;
+			truncated = truncated || (*d != '0');
+		}
+	}
+	for (char const* d = frac_begin; d < frac_end; ++d) {
+		if (leading && *d == '0') {
+			--q;
+			continue ;
+		}
+		leading = false;
+		if (taken < 19) {
+			w = w * 10 + uint64_t(*d - '0');
+			++taken;
+			--q;
+		} else {
+			truncated = truncated || (*d != '0');
+		}
+	}
+
+	p = cur;
+	if (w == 0 || q < smallest_power_of_five) {
+		f = negative ? -0.0 : 0.0;
+		return (true);
+	}
+	if (q > largest_power_of_five) {
+		return (false);
+	}
+
+	// exact when both w and 10^q are exact doubles (Clinger)
+	if (!truncated && q >= -22 && q <= 22 && w <= (uint64_t(1) << 53)) {
+		double	d = double(w);
+		d = (q < 0) ? d / exact_powers_of_ten[-q] : d * exact_powers_of_ten[q];
+		f = negative ? -d : d;
+		return (true);
+	}
+
+	uint64_t	mantissa;
+	int			power2;
+	compute_float(int(q), w, mantissa, power2);
+	if (truncated) {
+		// the real value is between w and w + 1, both have to round the same way
+		uint64_t	mantissa_up;
+		int			power2_up;
+		compute_float(int(q), w + 1, mantissa_up, power2_up);
+		if (mantissa != mantissa_up || power2 != power2_up) {
+			if (!fallback_strtod(start, cur, f))
+				return (false);
+			return (f == f && f - f == 0);
+		}
+	}
+	if (power2 == infinite_power) {
+		return (false);
+	}
+	f = to_double(negative, mantissa, power2);
+	return (true);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Integer formatting                            */
+/* -------------------------------------------------------------------------- */
+
+static const char	digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+//	writes the digits of v right to left, ending at end, returns the first digit
+static char*	write_digits_backwards(char* end, uint64_t v) {
+	while (v >= 100) {
+		unsigned	pair = unsigned(v % 100) * 2;
+		v /= 100;
+		*--end = digit_pairs[pair + 1];
+		*--end = digit_pairs[pair];
+	}
+	if (v >= 10) {
+		*--end = digit_pairs[v * 2 + 1];
+		*--end = digit_pairs[v * 2];
+	} else {
+		*--end = char('0' + v);
+	}
+	return (end);
+}
+
+char*	format_int(char* buf, int64_t i) {
+	uint64_t	v = uint64_t(i);
+	if (i < 0) {
+		*buf++ = '-';
+		v = 0 - v;
+	}
+
+	char	tmp[20];
+	char*	first = write_digits_backwards(tmp + sizeof(tmp), v);
+	size_t	len = tmp + sizeof(tmp) - first;
+	std::memcpy(buf, first, len);
+	return (buf + len);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Float formatting                             */
+/* -------------------------------------------------------------------------- */
+
+/*
+	Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+	Accurately with Integers"). Produces digits inside the rounding
+	interval of the double, so the output always parses back exactly and
+	is the shortest possible for nearly all values.
+*/
+
+//	"do it yourself" floating point: f * 2^e
+struct DiyFp {
+	uint64_t	f;
+	int			e;
+
+	DiyFp(uint64_t f, int e) : f(f), e(e) {}
+};
+
+static inline DiyFp	diy_sub(DiyFp x, DiyFp y) {
+	return (DiyFp(x.f - y.f, x.e));
+}
+
+//	product rounded to the upper 64 bits
+static inline DiyFp	diy_mul(DiyFp x, DiyFp y) {
+	uint64_t	high, low;
+	full_multiplication(x.f, y.f, high, low);
+	high += (low >> 63);
+	return (DiyFp(high, x.e + y.e + 64));
+}
+
+static inline DiyFp	diy_normalize(DiyFp x) {
+	int	lz = __builtin_clzll(x.f);
+	return (DiyFp(x.f << lz, x.e - lz));
+}
+
+//	the value with the IEEE representation bits and the boundaries m- and m+ of its rounding interval
+//	(fraction is the number of fraction bits, bias the exponent bias plus fraction)
+static void	compute_boundaries(uint64_t bits, int fraction, int bias, DiyFp& w, DiyFp& w_minus, DiyFp& w_plus) {
+	uint64_t	F = bits & ((uint64_t(1) << fraction) - 1);
+	int			E = int(bits >> fraction);
+	DiyFp		v = (E == 0)
+		? DiyFp(F, 1 - bias)
+		: DiyFp(F + (uint64_t(1) << fraction), E - bias);
+
+	// the interval is asymmetric when v is a power of two
+	bool	lower_boundary_is_closer = (F == 0 && E > 1);
+	DiyFp	m_plus = DiyFp(2 * v.f + 1, v.e - 1);
+	DiyFp	m_minus = lower_boundary_is_closer
+		? DiyFp(4 * v.f - 1, v.e - 2)
+		: DiyFp(2 * v.f - 1, v.e - 1);
+
+	w_plus = diy_normalize(m_plus);
+	w_minus = DiyFp(m_minus.f << (m_minus.e - w_plus.e), w_plus.e);
+	w = diy_normalize(v);
+}
+
+//	target range of the binary exponent after scaling by the cached power
+static const int	grisu_alpha = -60;
+
+static CachedPower const&	cached_power_for(int e) {
+	int	f = grisu_alpha - e - 1;
+	int	k = (f * 78913) / (1 << 18) + (f > 0 ? 1 : 0);
+	int	index = (-cached_powers_min_exponent + k + (cached_powers_step - 1)) / cached_powers_step;
+	return (cached_powers_of_ten[index]);
+}
+
+//	number of decimal digits of n, and the largest power of ten <= n
+static int	largest_pow10(uint32_t n, uint32_t& pow10) {
+	static const uint32_t	powers[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+	};
+	int	k = 10;
+	while (k > 1 && n < powers[k - 1])
+		--k;
+	pow10 = powers[k - 1];
+	return (k);
+}
+
+//	moves the last digit closer to w while staying inside the interval
+static void	grisu_round(char* buf, int len, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k) {
+	while (rest < dist && delta - rest >= ten_k
+		&& (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+		--buf[len - 1];
+		rest += ten_k;
+	}
+}
+
+static void	grisu_digits(char* buf, int& len, int& decimal_exponent, DiyFp M_minus, DiyFp w, DiyFp M_plus) {
+	uint64_t	delta = diy_sub(M_plus, M_minus).f;
+	uint64_t	dist = diy_sub(M_plus, w).f;
+
+	// split M+ into integral (p1) and fractional (p2) parts
+	DiyFp		one(uint64_t(1) << -M_plus.e, M_plus.e);
+	uint32_t	p1 = uint32_t(M_plus.f >> -one.e);
+	uint64_t	p2 = M_plus.f & (one.f - 1);
+
+	uint32_t	pow10;
+	int			n = largest_pow10(p1, pow10);
+
+	while (n > 0) {
+		buf[len++] = char('0' + p1 / pow10);
+		p1 %= pow10;
+		--n;
+
+		uint64_t	rest = (uint64_t(p1) << -one.e) + p2;
+		if (rest <= delta) {
+			decimal_exponent += n;
+			grisu_round(buf, len, dist, delta, rest, uint64_t(pow10) << -one.e);
+			return ;
+		}
+		pow10 /= 10;
+	}
+
+	int	m = 0;
+	for (;;) {
+		p2 *= 10;
+		buf[len++] = char('0' + (p2 >> -one.e));
+		p2 &= one.f - 1;
+		++m;
+		delta *= 10;
+		dist *= 10;
+		if (p2 <= delta)
+			break ;
+	}
+	decimal_exponent -= m;
+	grisu_round(buf, len, dist, delta, p2, one.f);
+}
+
+//	digits of a positive, finite value given by its rounding interval: value = digits * 10^decimal_exponent
+static void	grisu2(char* buf, int& len, int& decimal_exponent, DiyFp w, DiyFp w_minus, DiyFp w_plus) {
+	CachedPower const&	cached = cached_power_for(w_plus.e);
+	DiyFp				c_minus_k(cached.f, cached.e);
+
+	DiyFp	sw = diy_mul(w, c_minus_k);
+	DiyFp	sw_minus = diy_mul(w_minus, c_minus_k);
+	DiyFp	sw_plus = diy_mul(w_plus, c_minus_k);
+
+	// shrink the interval by one unit to account for the rounding of the products
+	DiyFp	M_minus(sw_minus.f + 1, sw_minus.e);
+	DiyFp	M_plus(sw_plus.f - 1, sw_plus.e);
+
+	len = 0;
+	decimal_exponent = -cached.k;
+	grisu_digits(buf, len, decimal_exponent, M_minus, sw, M_plus);
+}
+
+//	fixed notation for decimal point positions in (min_exp, max_exp], exponent notation otherwise
+static const int	format_min_exp = -4;
+static const int	format_max_exp = 15;
+
+//	lays out the digits buf[0, k) with the decimal point n digits from the start
+static char*	format_digits(char* buf, int k, int n) {
+	// digits[000].0
+	if (k <= n && n <= format_max_exp) {
+		std::memset(buf + k, '0', size_t(n - k));
+		buf[n] = '.';
+		buf[n + 1] = '0';
+		return (buf + n + 2);
+	}
+
+	// dig.its
+	if (0 < n && n <= format_max_exp) {
+		std::memmove(buf + n + 1, buf + n, size_t(k - n));
+		buf[n] = '.';
+		return (buf + k + 1);
+	}
+
+	// 0.[000]digits
+	if (format_min_exp < n && n <= 0) {
+		std::memmove(buf + 2 - n, buf, size_t(k));
+		buf[0] = '0';
+		buf[1] = '.';
+		std::memset(buf + 2, '0', size_t(-n));
+		return (buf + 2 - n + k);
+	}
+
+	// d.igitse[-]xxx
+	if (k == 1) {
+		buf += 1;
+	} else {
+		std::memmove(buf + 2, buf + 1, size_t(k - 1));
+		buf[1] = '.';
+		buf += k + 1;
+	}
+	*buf++ = 'e';
+	return (format_int(buf, n - 1));
+}
+
+char*	format_double(char* buf, double f) {
+	if (f != f || f - f != 0) {
+		std::memcpy(buf, "null", 4);
+		return (buf + 4);
+	}
+
+	if (std::signbit(f)) {
+		*buf++ = '-';
+		f = -f;
+	}
+	if (f == 0) {
+		std::memcpy(buf, "0.0", 3);
+		return (buf + 3);
+	}
+
+	uint64_t	bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+	DiyFp		w(0, 0), w_minus(0, 0), w_plus(0, 0);
+	compute_boundaries(bits, mantissa_bits, 1075, w, w_minus, w_plus);
+
+	int	len;
+	int	decimal_exponent;
+	grisu2(buf, len, decimal_exponent, w, w_minus, w_plus);
+	return (format_digits(buf, len, len + decimal_exponent));
+}
+
+// the same with the rounding interval of the float, which is wider and needs fewer digits
+char*	format_float(char* buf, float f) {
+	if (f != f || f - f != 0) {
+		std::memcpy(buf, "null", 4);
+		return (buf + 4);
+	}
+
+	if (std::signbit(f)) {
+		*buf++ = '-';
+		f = -f;
+	}
+	if (f == 0) {
+		std::memcpy(buf, "0.0", 3);
+		return (buf + 3);
+	}
+
+	uint32_t	bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+	DiyFp		w(0, 0), w_minus(0, 0), w_plus(0, 0);
+	compute_boundaries(bits, 23, 150, w, w_minus, w_plus);
+
+	int	len;
+	int	decimal_exponent;
+	grisu2(buf, len, decimal_exponent, w, w_minus, w_plus);
+	char*	end = format_digits(buf, len, len + decimal_exponent);
+
+	// read back through a double the digits can round to the midpoint between two floats
+	// (7.038531e-26 is the only one), the digits of the double always read back exactly
+	char const*	p = buf;
+	int64_t		i;
+	double		back;
+	bool		is_float;
+	if (!parse_number(p, end, i, back, is_float) || float(back) != f)
+		return (format_double(buf, double(f)));
+	return (end);
+}
+
+} // namespace njson
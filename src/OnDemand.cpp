@@ -0,0 +1,421 @@
+#include "njson/on_demand.h"
+#include "njson/number.h"
+#include "Unescape.h"
+
+#include <cstring>
+
+namespace njson {
+
+// index of no node, returned on errors
+static const size_t	no_node = size_t(-1);
+
+static bool	is_space(char c) {
+	return (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f');
+}
+
+static char const*	skip_ws(char const* p, char const* end) {
+	while (p < end && is_space(*p))
+		++p;
+	return (p);
+}
+
+static bool	is_token_end(char c) {
+	return (is_space(c) || c == ',' || c == ':' || c == '}' || c == '{' || c == '[' || c == ']' || c == '"');
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Skipping                                  */
+/* -------------------------------------------------------------------------- */
+
+// p is just past the opening quote, returns the closing quote (null if there is none)
+static char const*	find_quote(char const* p, char const* end) {
+	while (true) {
+		char const*	quote = static_cast<char const*>(std::memchr(p, '\"', end - p));
+		if (quote == nullptr)
+			return (nullptr);
+
+		// escaped if preceded by an odd number of backslashes
+		char const*	b = quote;
+		while (b > p && b[-1] == '\\')
+			--b;
+		if (((quote - b) & 1) == 0)
+			return (quote);
+		p = quote + 1;
+	}
+}
+
+// characters the skip scan stops at
+static inline bool	is_skip_stop(char c) {
+	return (c == '"' || c == '[' || c == ']' || c == '{' || c == '}');
+}
+
+// p is inside a container, depth levels deep. Returns the position past its end, null if it isn't closed
+static char const*	skip_container(char const* p, char const* end, size_t depth) {
+	while (true) {
+		while (p < end && !is_skip_stop(*p))
+			++p;
+		if (p == end)
+			return (nullptr);
+
+		switch (*p) {
+			case '\"' :
+				p = find_quote(p + 1, end);
+				if (p == nullptr)
+					return (nullptr);
+				break ;
+			case '[' :
+			case '{' :
+				++depth;
+				break ;
+			default :
+				if (--depth == 0)
+					return (p + 1);
+		}
+		++p;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Document                                  */
+/* -------------------------------------------------------------------------- */
+
+JsonOnDemand::JsonOnDemand()
+: data(nullptr), input_end(nullptr), error(false) {}
+
+JsonOnDemand::JsonOnDemand(char const* data, size_t length, std::shared_ptr<void const> owner)
+: owner(std::move(owner)), data(data), input_end(data + length), error(false) {
+	char const*	p = skip_ws(data, input_end);
+	if (p != input_end && add_node(p) != no_node && nodes[0].end != nullptr)
+		ended(0);
+}
+
+JsonOnDemand::Value JsonOnDemand::root(void) const {
+	if (nodes.empty())
+		return (Value());
+	return (Value(this, 0));
+}
+
+bool JsonOnDemand::set_error(std::string const& str) const {
+	if (!error) {
+		errmsg = str;
+		error = true;
+	}
+	return (false);
+}
+
+// adds the value that starts at p, scalars are checked right away
+size_t JsonOnDemand::add_node(char const* p) const {
+	Node	node;
+	node.begin = p;
+	node.end = nullptr;
+	node.resume = nullptr;
+	node.escaped = false;
+
+	switch (*p) {
+		case '{' :
+		case '[' :
+			node.type = (*p == '{') ? Json::OBJECT : Json::ARRAY;
+			node.resume = p + 1;
+			break ;
+		case '\"' : {
+			char const*	quote = find_quote(p + 1, input_end);
+			if (quote == nullptr) {
+				set_error("string not encapsulated by '\"'");
+				return (no_node);
+			}
+			node.type = Json::STRING;
+			node.end = quote + 1;
+			node.str = StringRef(p + 1, quote - p - 1);
+			node.escaped = std::memchr(p + 1, '\\', quote - p - 1) != nullptr;
+			break ;
+		}
+		default : {
+			char const*	last = p;
+			while (last < input_end && !is_token_end(*last))
+				++last;
+			node.end = last;
+
+			Json::number_int	_int;
+			Json::number_float	_float;
+			bool				is_float;
+			char const*			q = p;
+			size_t				len = last - p;
+			if (*p == '-' || (*p >= '0' && *p <= '9')) {
+				if (!parse_number(q, last, _int, _float, is_float) || q != last) {
+					set_error("invalid number: " + std::string(p, last));
+					return (no_node);
+				}
+				node.type = is_float ? Json::NUMBER_FLOAT : Json::NUMBER_INT;
+			} else if ((len == 4 && std::memcmp(p, "true", 4) == 0) || (len == 5 && std::memcmp(p, "false", 5) == 0)) {
+				node.type = Json::BOOL;
+			} else if (len == 4 && std::memcmp(p, "null", 4) == 0) {
+				node.type = Json::NULL_T;
+			} else {
+				set_error("unrecognized token: " + std::string(p, last == p ? p + 1 : last));
+				return (no_node);
+			}
+		}
+	}
+	nodes.push_back(std::move(node));
+	return (nodes.size() - 1);
+}
+
+// reads the next child of the container at idx, false if there are no more (or on an error)
+bool JsonOnDemand::read_child(size_t idx) const {
+	char const*	p = nodes[idx].resume;
+	if (p == nullptr)
+		return (false);
+
+	bool	object = nodes[idx].type == Json::OBJECT;
+	char	close = object ? '}' : ']';
+	bool	first = nodes[idx].children.empty();
+
+	p = skip_ws(p, input_end);
+	if (first && p < input_end && *p == close) {
+		nodes[idx].resume = nullptr;
+		nodes[idx].end = p + 1;
+		ended(idx);
+		return (false);
+	}
+
+	Child	child;
+	if (object) {
+		if (p == input_end || *p != '\"')
+			return (set_error("bad object, key not encapsulated by quotes"));
+		char const*	quote = find_quote(p + 1, input_end);
+		if (quote == nullptr)
+			return (set_error("string not encapsulated by '\"'"));
+		child.key = decode(p + 1, quote);
+		p = skip_ws(quote + 1, input_end);
+		if (p == input_end || *p != ':')
+			return (set_error("bad object, key not followed by ':'"));
+		p = skip_ws(p + 1, input_end);
+	}
+	if (p == input_end)
+		return (set_error(object ? "object not closed by '}'" : "array not closed by ']'"));
+
+	child.node = add_node(p);
+	if (child.node == no_node)
+		return (false);
+	char const*	end = value_end(child.node);
+	if (end == nullptr)
+		return (false);
+	nodes[idx].children.push_back(child);
+
+	// the child is known, find where the next one starts
+	p = skip_ws(end, input_end);
+	if (p < input_end && *p == ',') {
+		nodes[idx].resume = p + 1;
+	} else if (p < input_end && *p == close) {
+		nodes[idx].resume = nullptr;
+		nodes[idx].end = p + 1;
+		ended(idx);
+	} else {
+		// the container ends here, the child is kept
+		nodes[idx].resume = nullptr;
+		if (p == input_end)
+			set_error(object ? "object not closed by '}'" : "array not closed by ']'");
+		else
+			set_error(object ? "bad object, elements not seperated by ','" : "bad array, elements not seperated by ','");
+	}
+	return (true);
+}
+
+bool JsonOnDemand::read_all(size_t idx) const {
+	while (read_child(idx))
+		;
+	return (!error);
+}
+
+// past the value at idx, the rest of a container is skipped if it wasn't read
+char const* JsonOnDemand::value_end(size_t idx) const {
+	Node&	node = nodes[idx];
+	if (node.end == nullptr) {
+		node.end = skip_container(node.resume, input_end, 1);
+		if (node.end == nullptr)
+			set_error(node.type == Json::OBJECT ? "object not closed by '}'" : "array not closed by ']'");
+		else
+			ended(idx);
+	}
+	return (node.end);
+}
+
+// the end of the value at idx was found, only whitespace may follow the root value
+void JsonOnDemand::ended(size_t idx) const {
+	if (idx == 0 && skip_ws(nodes[0].end, input_end) != input_end)
+		set_error("unexpected data after the document");
+}
+
+// the contents of [begin, end), decoded if they contain escapes
+StringRef JsonOnDemand::decode(char const* begin, char const* end) const {
+	if (std::memchr(begin, '\\', end - begin) == nullptr)
+		return (StringRef(begin, end - begin));
+	decoded.emplace_back();
+	if (unescape_string(begin, end, decoded.back()) == nullptr)
+		set_error("bad escape sequence in string");
+	return (StringRef(decoded.back()));
+}
+
+StringRef JsonOnDemand::string_value(size_t idx) const {
+	Node&	node = nodes[idx];
+	if (node.escaped) {
+		node.str = decode(node.str.data(), node.str.data() + node.str.size());
+		node.escaped = false;
+	}
+	return (node.str);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Value                                   */
+/* -------------------------------------------------------------------------- */
+
+Json::Type JsonOnDemand::Value::get_type(void) const {
+	if (doc == nullptr)
+		return (Json::NULL_T);
+	return (doc->nodes[idx].type);
+}
+
+void JsonOnDemand::Value::check_type(Json::Type type) const {
+	if (get_type() != type) {
+		throw(Json::json_exception("incorrect type. Expected: "
+			+ get_type_string()
+			+ ", given: "
+			+ Json::get_type_string(type)));
+	}
+}
+
+size_t JsonOnDemand::Value::size(void) const {
+	Json::Type	type = get_type();
+	if (type != Json::ARRAY && type != Json::OBJECT)
+		return (0);
+	doc->read_all(idx);
+	return (doc->nodes[idx].children.size());
+}
+
+JsonOnDemand::Value JsonOnDemand::Value::find(StringRef key) const {
+	if (get_type() != Json::OBJECT)
+		return (Value());
+
+	// the members that were read before, then read on until the key shows up
+	std::vector<Child> const&	children = doc->nodes[idx].children;
+	for (size_t i = 0; i < children.size(); ++i) {
+		if (children[i].key == key)
+			return (Value(doc, children[i].node));
+	}
+	while (doc->read_child(idx)) {
+		Child const&	child = doc->nodes[idx].children.back();
+		if (child.key == key)
+			return (Value(doc, child.node));
+	}
+	return (Value());
+}
+
+JsonOnDemand::Value JsonOnDemand::Value::at(size_t index) const {
+	Json::Type	type = get_type();
+	if (type != Json::ARRAY && type != Json::OBJECT)
+		return (Value());
+	while (doc->nodes[idx].children.size() <= index) {
+		if (!doc->read_child(idx))
+			return (Value());
+	}
+	return (Value(doc, doc->nodes[idx].children[index].node));
+}
+
+StringRef JsonOnDemand::Value::key_at(size_t index) const {
+	if (get_type() != Json::OBJECT)
+		return (StringRef());
+	at(index);
+	std::vector<Child> const&	children = doc->nodes[idx].children;
+	return (index < children.size() ? children[index].key : StringRef());
+}
+
+Json::pointer_t JsonOnDemand::Value::to_json(void) const {
+	if (doc == nullptr)
+		return (Json::null_ptr());
+	char const*	end = doc->value_end(idx);
+	if (end == nullptr)
+		return (Json::null_ptr());
+
+	char const*	begin = doc->nodes[idx].begin;
+	JsonParser	parser(begin, end - begin);
+	Json::pointer_t	json = parser.parse();
+	if (parser.has_error())
+		doc->set_error(parser.get_error_msg());
+	return (json);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   is/get                                   */
+/* -------------------------------------------------------------------------- */
+
+template<> bool JsonOnDemand::Value::is<Json::null_t>(void) const { return get_type() == Json::NULL_T; }
+template<> bool JsonOnDemand::Value::is<Json::array>(void) const { return get_type() == Json::ARRAY; }
+template<> bool JsonOnDemand::Value::is<Json::object>(void) const { return get_type() == Json::OBJECT; }
+template<> bool JsonOnDemand::Value::is<Json::string>(void) const { return get_type() == Json::STRING; }
+template<> bool JsonOnDemand::Value::is<StringRef>(void) const { return get_type() == Json::STRING; }
+template<> bool JsonOnDemand::Value::is<Json::number_float>(void) const { return get_type() == Json::NUMBER_FLOAT; }
+template<> bool JsonOnDemand::Value::is<Json::number_int>(void) const { return get_type() == Json::NUMBER_INT; }
+template<> bool JsonOnDemand::Value::is<bool>(void) const { return get_type() == Json::BOOL; }
+
+template<> Json::string JsonOnDemand::Value::get<Json::string>(void) const {
+	check_type(Json::STRING);
+	return (doc->string_value(idx).str());
+}
+
+template<> StringRef JsonOnDemand::Value::get<StringRef>(void) const {
+	check_type(Json::STRING);
+	return (doc->string_value(idx));
+}
+
+template<> Json::number_float JsonOnDemand::Value::get<Json::number_float>(void) const {
+	check_type(Json::NUMBER_FLOAT);
+	Node const&			node = doc->nodes[idx];
+	char const*			p = node.begin;
+	Json::number_int	_int;
+	Json::number_float	_float;
+	bool				is_float;
+	parse_number(p, node.end, _int, _float, is_float);
+	return (_float);
+}
+
+template<> Json::number_int JsonOnDemand::Value::get<Json::number_int>(void) const {
+	check_type(Json::NUMBER_INT);
+	Node const&			node = doc->nodes[idx];
+	char const*			p = node.begin;
+	Json::number_int	_int;
+	Json::number_float	_float;
+	bool				is_float;
+	parse_number(p, node.end, _int, _float, is_float);
+	return (_int);
+}
+
+template<> bool JsonOnDemand::Value::get<bool>(void) const {
+	check_type(Json::BOOL);
+	return (*doc->nodes[idx].begin == 't');
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+JsonOnDemand	JsonParser::parse_on_demand(void) {
+	if (error) {
+		return (JsonOnDemand());
+	}
+	if (from_stream && !read_stream()) {
+		return (JsonOnDemand());
+	}
+
+	// the document takes the rest of the input
+	std::shared_ptr<void const>	owner;
+	if (from_stream)
+		owner = buffer;
+	else if (mapping)
+		owner = mapping;
+	JsonOnDemand	doc(cur, end - cur, std::move(owner));
+	cur = end;
+	reset_index();
+	return (doc);
+}
+
+} // namespace njson
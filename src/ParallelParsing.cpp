@@ -0,0 +1,204 @@
+#include "njson/njson.h"
+#include "njson/sax.h"
+#include "DomBuilder.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace njson {
+
+/*
+	Parallel parse() of a document that is one large top-level array.
+
+	The structural index already holds every token outside of strings,
+	so one walk over it (counting the nesting depth) finds the commas
+	between the top-level elements. The elements are grouped into ranges
+	of about equal size, every thread parses ranges with a parser of its
+	own that shares the index of the input, and the results are joined
+	into one array in input order.
+
+	Each range is parsed into an arena (and key pool) of its own, which
+	the containers, keys and string views of its elements keep alive. When a range
+	fails to parse, parse() starts over without threads, so errors are
+	reported exactly as without threads.
+*/
+
+// smaller inputs aren't worth starting threads for
+static const size_t	parallel_threshold = size_t(1) << 20;
+
+// a thread gets ranges of at least this many bytes
+static const size_t	min_range_size = size_t(64) << 10;
+
+namespace {
+
+// elements between two index entries: the first token of the first element and the ',' or ']' after the last
+struct ElementRange {
+	uint32_t const*		first;
+	uint32_t const*		last;
+	std::vector<Json>	elements;
+	bool				ok;
+};
+
+} // namespace
+
+// parses the elements in [first, last) of the index of parser, which this parser shares
+bool JsonParser::parse_elements(JsonParser const& parser, uint32_t const* first, uint32_t const* last,
+	std::vector<Json>& out) {
+	from_stream = parser.from_stream;
+	buffer = parser.buffer;
+	mapping = parser.mapping;
+	use_arena = parser.use_arena;
+	intern_keys = parser.intern_keys;
+	key_schema = parser.key_schema;
+	use_string_views = parser.use_string_views;
+	// the elements are one level down
+	max_depth = parser.max_depth - 1;
+
+	index_base = parser.index_base;
+	cur = index_base + *first;
+	end = index_base + *last;
+	next_token = first + 1;
+	last_token = last;
+	error = false;
+
+	arena = new_arena(end - cur);
+	if (intern_keys) {
+		keys.reset(arena);
+	}
+
+	bool	ok = true;
+	{
+		DomBuilder	builder(arena, keys, intern_keys, build_stacks);
+		builder.set_schema(key_schema.get());
+		if (use_string_views && arena != nullptr)
+			builder.set_input(parser.cur, parser.end);
+#ifdef NJSON_STATS
+		StatsHandler<DomBuilder>	counted(builder, *StatsCollector::active());
+#endif
+
+		while (ok) {
+#ifdef NJSON_STATS
+			if (cur == end || !parse_value(counted, *cur++)) {
+#else
+			if (cur == end || !parse_value(builder, *cur++)) {
+#endif
+				ok = false;
+				break ;
+			}
+			out.push_back(builder.take());
+
+			skip_ws();
+			if (cur == end) {
+				break ;
+			}
+			if (*cur != ',') {
+				ok = false;
+				break ;
+			}
+			++cur;
+			skip_ws();
+		}
+	}
+
+	keys.reset(nullptr);
+	if (arena != nullptr) {
+		arena->share();
+		arena->release();
+		arena = nullptr;
+	}
+	return (ok);
+}
+
+Json::pointer_t JsonParser::parse_parallel(void) {
+	if (next_token == nullptr || *cur != '[' || size_t(end - cur) < parallel_threshold || max_depth == 0) {
+		return (nullptr);
+	}
+
+	size_t	n = threads;
+	if (n == 0) {
+		n = std::thread::hardware_concurrency();
+	}
+	if (n <= 1) {
+		return (nullptr);
+	}
+
+	// split the elements into ranges at top-level commas
+	size_t						range_size = std::max(min_range_size, size_t(end - cur) / (n * 8));
+	std::vector<ElementRange>	ranges;
+	uint32_t const*				first = next_token;
+	uint32_t const*				close = nullptr;
+	size_t						depth = 1;
+
+	for (uint32_t const* token = next_token; token < last_token; ++token) {
+		char	c = index_base[*token];
+		if (c == '[' || c == '{') {
+			++depth;
+		} else if (c == ']' || c == '}') {
+			if (--depth == 0) {
+				close = token;
+				break ;
+			}
+		} else if (c == ',' && depth == 1 && *token - *first >= range_size) {
+			ranges.push_back(ElementRange{first, token, {}, false});
+			first = token + 1;
+		}
+	}
+	// not closed (an error) or an empty array, the sequential parse handles those
+	if (close == nullptr || first == close) {
+		return (nullptr);
+	}
+	ranges.push_back(ElementRange{first, close, {}, false});
+
+	// the calling thread parses ranges as well, thread is the number of the worker
+	std::atomic<size_t>	next_range(0);
+	NJSON_STAT(std::vector<ParseStats>	thread_stats(std::min(n, ranges.size())));
+	auto				work = [&](size_t thread) {
+		(void)thread;	// only the stats are per thread
+		JsonParser	parser;
+		NJSON_STAT(StatsCollector	collector(thread_stats[thread], parser.cur, 1));
+		for (size_t i; (i = next_range.fetch_add(1)) < ranges.size();) {
+			ranges[i].ok = parser.parse_elements(*this, ranges[i].first, ranges[i].last, ranges[i].elements);
+		}
+	};
+	std::vector<std::thread>	workers;
+	for (size_t i = 1; i < std::min(n, ranges.size()); ++i) {
+		workers.emplace_back(work, i);
+	}
+	work(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	size_t	count = 0;
+	for (ElementRange const& range : ranges) {
+		if (!range.ok) {
+			return (nullptr);
+		}
+		count += range.elements.size();
+	}
+	NJSON_STAT(for (ParseStats const& other : thread_stats) merge_stats(stats, other));
+	NJSON_STAT(++stats.nodes[Json::ARRAY]);
+	NJSON_STAT(stats.max_depth = std::max<size_t>(stats.max_depth, 1));
+
+	Arena*		root_arena = new_arena(0);
+	Json::array	elements{Json::array::allocator_type(root_arena)};
+	elements.reserve(count);
+	for (ElementRange& range : ranges) {
+		std::move(range.elements.begin(), range.elements.end(), std::back_inserter(elements));
+	}
+	Json::pointer_t	result(new (root_arena) Json(std::move(elements)));
+	if (root_arena != nullptr) {
+		root_arena->share();
+		root_arena->release();
+	}
+
+	// continue after the array, like the sequential parse
+	cur = index_base + *close + 1;
+	next_token = close + 1;
+	return (result);
+}
+
+} // namespace njson
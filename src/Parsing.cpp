@@ -1,181 +1,196 @@
 #include "njson/njson.h"
-
+#include "njson/number.h"
+#include "njson/sax.h"
+#include "DomBuilder.h"
+#include "PushParser.h"
+#include "Stats.h"
+#include "StructuralIndex.h"
+#include "Unescape.h"
+
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
 namespace njson {
 
-static bool	is_delimiter(char c) {
+bool	JsonParser::is_delimiter(char c) {
 	return (c == ',' || c == ':' || c == '}' || c == '{' || c == '[' || c == ']');
 }
 
-static void	trim(std::string& str) {
-	size_t p1 = str.find_last_of('\"');
-	size_t p2 = str.find_first_of('\"');
-
-	if (p1 != std::string::npos) {
-		str.erase(p1, 1);
-	}
-
-	if (p2 != std::string::npos) {
-		str.erase(p2, 1);
-	}
+bool	JsonParser::is_space(char c) {
+	return (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f');
 }
 
-static std::string get_next_token(std::istream& stream) {
-	stream >> std::ws;
-	
-	std::string str = {(char)stream.get()};
-	if (is_delimiter(str[0])) {
-		return (str);
+// reads the whole stream into the buffer on the first call, later calls parse what's left of it
+bool JsonParser::read_stream(void) {
+	if (cur != nullptr) {
+		return (true);
 	}
-
-	if (str[0] == '"') {
-		while (!stream.eof()) {
-			char c = stream.get();
-			str += c;
-			if (c == '\"')
-				return (str);
-		}
+	if (!stream) {
+		return (set_error("bad input stream"));
 	}
+	buffer = std::make_shared<std::string>();
 
-	while (!stream.eof() && !is_delimiter(stream.peek()) && !std::isspace(stream.peek())) {
-		str += stream.get();
+	char	chunk[1 << 16];
+	while (stream) {
+		stream.read(chunk, sizeof(chunk));
+		buffer->append(chunk, stream.gcount());
 	}
-
-	return (str);
+	cur = buffer->data();
+	end = cur + buffer->size();
+	reset_index();
+	return (true);
 }
 
-// set error msg and return null-json
-Json::pointer_t JsonParser::set_error(std::string const& str) {
-	errmsg = str;
-	error = true;
-	return (Json::null_ptr());
+void JsonParser::reset_index(void) {
+	index.clear();
+	index_base = nullptr;
+	next_token = nullptr;
+	last_token = nullptr;
 }
 
-Json::pointer_t JsonParser::state_object(void) {
-	Json::pointer_t object = Json::pointer_t(new Json(Json::object{}));
-
-	std::string	token;
-	while (!stream.eof() && (token = get_next_token(stream)) != "}") {
-		std::string	key;
-		if (object->get<Json::object>().size() > 0) {
-			if (token[0] == ',') {
-				stream >> std::ws;
-				token = get_next_token(stream);
-			} else {
-				return set_error("bad object, elements not seperated by ','");
-			}
-		}
-
-		if (is_delimiter(token[0])) {
-			return set_error(std::string{"bad object, unexpected token: '"} + token[0] + '\'');
-		}
+// small inputs are scanned directly, indexing them costs more than it saves
+static const size_t	index_threshold = 512;
 
-		key = token;
-		if (key.back() == '\"' && key.front() != '\"') {
-			return set_error("bad object, key not encapsulated by quotes");
-		}
-
-		trim(key);
-		token = get_next_token(stream);
-		if (token[0] != ':') {
-			return set_error("bad object, key not followed by ':'");
-		}
+// indexes [cur, end) unless it was already indexed by a previous parse()
+void JsonParser::prepare_index(void) {
+	if (index_base != nullptr || !use_index) {
+		return ;
+	}
+	size_t	len = end - cur;
+	if (len < index_threshold || len > structural_index_max_size) {
+		return ;
+	}
+	build_structural_index(cur, len, index);
+	index_base = cur;
+	next_token = index.data();
+	last_token = index.data() + index.size();
+}
 
-		stream >> std::ws;
-		
-		// Go deeper into recursion
-		object->add_to_object(key, run_state(get_state_from_c(stream.get())));
-		if (!object->get<Json::object>()[key]) {
-			return (Json::pointer_t(new Json()));
-		}
+// moves cur to the start of the next token
+void JsonParser::skip_ws(void) {
+	if (next_token != nullptr) {
+		cur = (next_token < last_token) ? index_base + *next_token++ : end;
+		return ;
 	}
+	while (cur < end && is_space(*cur)) {
+		++cur;
+	}
+}
 
-	if (token != "}") {
-		return set_error("object not closed by '}'");
+// end of a bare (number/word) token
+char const* JsonParser::token_end(void) const {
+	char const*	p = cur;
+	while (p < end && !is_delimiter(*p) && !is_space(*p) && *p != '"') {
+		++p;
 	}
-	return (object);
+	return (p);
 }
 
-Json::pointer_t JsonParser::state_array(void) {
-	Json::pointer_t _array = Json::pointer_t(new Json(Json::array{}));
+// cur is just past the opening quote, on success cur is just past the closing quote.
+// Only finds the end of the string (the raw characters in str), escapes are decoded by scan_string_ref()
+bool JsonParser::scan_string_view(StringRef& str, bool& escaped) {
+	char const*	data = cur;
+	escaped = false;
+
+	// most strings have no escapes, then the closing quote is the first quote
+	char const*	quote = static_cast<char const*>(std::memchr(cur, '\"', end - cur));
+	if (quote != nullptr && std::memchr(cur, '\\', quote - cur) == nullptr) {
+		str = StringRef(data, quote - cur);
+		cur = quote + 1;
+		return (true);
+	}
 
-	while (!stream.eof()) {
-		stream >> std::ws;
-		char c = stream.peek();
-		if (c == ']') {
-			stream.get();
-			return (_array);
+	while (cur < end) {
+		char	c = *cur++;
+		if (c == '\"') {
+			str = StringRef(data, cur - 1 - data);
+			return (true);
 		}
-		if (_array->get<Json::array>().size() > 0) {
-			if (c == ',') {
-				stream.get();
-				stream >> std::ws;
-				c = stream.peek();
-			} else {
-				return set_error("bad array, elements not seperated by ','");
+		if (c == '\\') {
+			escaped = true;
+			if (cur == end) {
+				break ;
 			}
+			++cur;
 		}
-		// Go deeper into recursion
-		_array->get<Json::array>().emplace_back(run_state(get_state_from_c(stream.get())));
 	}
-	return (set_error("array not closed by ']'"));
+	return (false);
 }
 
-Json::pointer_t JsonParser::state_string(void) {
-	stream.unget();
-	std::string	str = get_next_token(stream);
-
-	if (str.back() != '\"') {
-		return set_error("string not encapsulated by '\"'");
+// the string at cur, pointing into the input unless it has to be decoded into string_buffer.
+// Sets the error on an unterminated string or a bad escape
+bool JsonParser::scan_string_ref(StringRef& str) {
+	StringRef	raw;
+	bool		escaped;
+	if (!scan_string_view(raw, escaped)) {
+		return (set_error("string not encapsulated by '\"'"));
+	}
+	if (!escaped) {
+		str = raw;
+		return (true);
+	}
+	string_buffer.clear();
+	if (unescape_string(raw.data(), raw.data() + raw.size(), string_buffer) == nullptr) {
+		return (set_error("bad escape sequence in string"));
 	}
-	trim(str);
-	return Json::pointer_t(new Json(str));
+	str = StringRef(string_buffer);
+	return (true);
 }
 
-Json::pointer_t JsonParser::state_number(void) {
-	std::string	str;
+// set error msg, returns false so it can end the parse
+bool JsonParser::set_error(std::string const& str) {
+	errmsg = str;
+	error = true;
+	return (false);
+}
 
-	stream.unget();
-	str = get_next_token(stream);
-	// Float
-	if (str.find('.') != std::string::npos) {
-		Json::number_float _float;
-		try {
-			_float = std::stod(str);
-		}
-		catch (std::invalid_argument& e) { return set_error(std::string {"stod: "} + e.what()); }
-		catch (std::out_of_range& e) { return set_error(std::string {"stod: "} + e.what()); }
-		return (Json::pointer_t(new Json(_float)));
-	
-	// Integer
-	} else {
-		Json::number_int _int;
-		try {
-			_int = std::stoll(str);
-		}
-		catch (std::invalid_argument& e) { return set_error(std::string {"stoll: "} + e.what()); }
-		catch (std::out_of_range& e) { return set_error(std::string {"stoll: "} + e.what()); }
-		return (Json::pointer_t(new Json(_int)));
+bool JsonParser::stopped(void) {
+	return (set_error("stopped by handler"));
+}
+
+// scans the number token at cur, the result is stored in _int or _float depending on is_float
+bool JsonParser::scan_number(Json::number_int& _int, Json::number_float& _float, bool& is_float) {
+	char const*	last = token_end();
+	char const*	p = cur;
+
+	NJSON_STAT(StatsCollector*	collector = StatsCollector::active());
+	NJSON_STAT(StatsTimer	timer(collector != nullptr ? &collector->number : nullptr));
+
+	// the whole token has to be the number
+	if (!parse_number(p, last, _int, _float, is_float) || p != last) {
+		set_error("invalid number: " + std::string(cur, last));
+		return (false);
 	}
+	cur = last;
+	return (true);
 }
 
-Json::pointer_t JsonParser::state_word(void) {
-	stream.unget();
-	stream >> std::ws;
+static bool	token_is(char const* begin, char const* end, char const* word) {
+	size_t	len = std::strlen(word);
+	return (size_t(end - begin) == len && std::memcmp(begin, word, len) == 0);
+}
+
+// scans the word token at cur, returns 't', 'f' or 'n' for true, false and null (0 on error)
+char JsonParser::scan_word(void) {
+	char const*	word = cur;
+	cur = token_end();
 
-	std::string word = get_next_token(stream);
-	if (word == "true") {
-		return (Json::pointer_t(new Json(true)));
+	if (token_is(word, cur, "true")) {
+		return ('t');
 	}
-	if (word == "false") {
-		return (Json::pointer_t(new Json(false)));
+	if (token_is(word, cur, "false")) {
+		return ('f');
 	}
-	if (word == "null") {
-		return (Json::pointer_t(new Json()));
+	if (token_is(word, cur, "null")) {
+		return ('n');
 	}
-	return (set_error("unrecognized token: " + word));
+	if (word == cur) {
+		// a delimiter where a value was expected
+		++cur;
+	}
+	set_error("unrecognized token: " + std::string(word, cur));
+	return (0);
 }
 
 JsonParser::State JsonParser::get_state_from_c(char c) {
@@ -192,23 +207,19 @@ JsonParser::State JsonParser::get_state_from_c(char c) {
 	return (WORD);
 }
 
-Json::pointer_t JsonParser::run_state(State state) {
-	switch (state) {
-		case OBJECT : return (state_object());
-		case ARRAY : return (state_array());
-		case STRING : return (state_string());
-		case NUMBER : return (state_number());
-		case WORD :
-		default :
-			return (state_word());
-	}
-}
-
 // CONSTRUCTORS
-JsonParser::JsonParser() : holder(std::ifstream()), stream(holder), error(false), errmsg("") {}
+static const size_t	default_max_depth = 1024;
+
+JsonParser::JsonParser()
+: holder(std::ifstream()), stream(holder), error(false), errmsg(""),
+from_stream(true), cur(nullptr), end(nullptr), use_arena(true), arena(nullptr), threads(1), max_depth(default_max_depth), intern_keys(true), use_string_views(false),
+use_index(true), index_base(nullptr), next_token(nullptr), last_token(nullptr) {}
 
-JsonParser::JsonParser(std::string const& path)
-: holder(std::ifstream(path)), stream(holder), error(false), errmsg("") {
+JsonParser::JsonParser(std::string const& path) : JsonParser() {
+	open(path);
+	if (!from_stream) {
+		return ;
+	}
 	if (!stream) {
 		error = true;
 		errmsg = "bad input stream";
@@ -217,29 +228,143 @@ JsonParser::JsonParser(std::string const& path)
 
 JsonParser::JsonParser(char const* path) : JsonParser(std::string {path}) {}
 
-JsonParser::JsonParser(std::istream& stream) : stream(stream), error(false), errmsg("") {
+JsonParser::JsonParser(std::istream& stream)
+: stream(stream), error(false), errmsg(""),
+from_stream(true), cur(nullptr), end(nullptr), use_arena(true), arena(nullptr), threads(1), max_depth(default_max_depth), intern_keys(true), use_string_views(false),
+use_index(true), index_base(nullptr), next_token(nullptr), last_token(nullptr) {
 	if (!stream) {
 		error = true;
 		errmsg = "bad input stream";
 	}
 }
 
+JsonParser::JsonParser(char const* data, size_t length)
+: holder(std::ifstream()), stream(holder), error(false), errmsg(""),
+from_stream(false), cur(data), end(data + length), use_arena(true), arena(nullptr), threads(1), max_depth(default_max_depth), intern_keys(true), use_string_views(false),
+use_index(true), index_base(nullptr), next_token(nullptr), last_token(nullptr) {}
+
+bool JsonParser::start_input(void) {
+	if (error) return (false);
+	if (from_stream && !read_stream()) return (false);
+
+	prepare_index();
+	skip_ws();
+	return (true);
+}
+
+bool JsonParser::end_document(void) {
+	skip_ws();
+	if (cur != end)
+		return (set_error("unexpected data after the document"));
+	return (true);
+}
+
+// a new arena for a document of about size bytes (null without arena), the parser holds one reference
+Arena* JsonParser::new_arena(size_t size) const {
+	if (!use_arena) {
+		return (nullptr);
+	}
+	// small documents (json lines, messages) don't need a full-sized first block
+	Arena*	arena = new Arena(size * 2);
+	arena->retain();
+	if (use_string_views) {
+		if (from_stream)
+			arena->keep_alive(buffer);
+		else if (mapping)
+			arena->keep_alive(mapping);
+	}
+	return (arena);
+}
+
 Json::pointer_t	JsonParser::parse(void) {
-	if (error) return Json::null_ptr();
-	if (!stream) return set_error("bad input stream");
+	NJSON_STAT(stats = ParseStats());
+	NJSON_STAT(StatsCollector	collector(stats, cur));
+	if (!start_input() || cur == end) return Json::null_ptr();
+	NJSON_STAT(collector.start_input());
+
+	if (threads != 1) {
+		Json::pointer_t	root = parse_parallel();
+		if (root && !end_document())
+			return (Json::null_ptr());
+		if (root)
+			return (root);
+	}
 
-	stream >> std::ws;
-	if (stream.eof()) return Json::null_ptr();
+	// the parser keeps the arena alive while building, the nodes keep it alive afterwards
+	arena = new_arena(end - cur);
+	if (intern_keys) {
+		keys.reset(arena);
+	}
+
+	Json::pointer_t	root;
+	{
+		DomBuilder	builder(arena, keys, intern_keys, build_stacks);
+		builder.set_schema(key_schema.get());
+		if (use_string_views && arena != nullptr)
+			builder.set_input(cur, end);
+#ifdef NJSON_STATS
+		StatsHandler<DomBuilder>	counted(builder, collector);
+		if (parse_document(counted))
+			root = builder.release();
+#else
+		if (parse_document(builder))
+			root = builder.release();
+#endif
+	}
 
-	return run_state(get_state_from_c(stream.get()));
+	keys.reset(nullptr);
+	if (arena != nullptr) {
+		arena->share();
+		arena->release();
+		arena = nullptr;
+	}
+	if (!root)
+		return (Json::null_ptr());
+	return (root);
 }
 
 void JsonParser::open(std::string const& path) {
-	this->holder.open(path);
+	this->buffer.reset();
+	this->reset_index();
+	this->mapping = std::make_shared<MappedFile>(path);
+	if (this->mapping->is_open()) {
+		this->from_stream = false;
+		this->cur = this->mapping->data();
+		this->end = this->cur + this->mapping->size();
+		return ;
+	}
+
+	// not mappable (pipe, special file, no mmap support), read it as a stream instead
+	this->mapping.reset();
+	this->holder.open(path, std::ios::binary);
+	this->from_stream = true;
+	this->cur = nullptr;
+	this->end = nullptr;
+}
+
+// out of line, the push state is an incomplete type in njson.h
+JsonParser::~JsonParser() {}
+
+void JsonParser::open(char const* data, size_t length) {
+	this->buffer.reset();
+	this->mapping.reset();
+	if (this->holder.is_open())
+		this->holder.close();
+	this->reset_index();
+	this->push.reset();
+	this->from_stream = false;
+	this->cur = data;
+	this->end = data + length;
+	this->error = false;
+	this->errmsg.clear();
 }
 
 void JsonParser::close(void) {
 	this->holder.close();
+	this->mapping.reset();
+	this->reset_index();
+	this->cur = nullptr;
+	this->end = nullptr;
 }
 
 } // namespace njson
@@ -0,0 +1,81 @@
+#include "njson/path.h"
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                Construction                                */
+/* -------------------------------------------------------------------------- */
+
+// array index of a segment: digits without leading zeros
+static size_t	segment_index(std::string const& segment) {
+	if (segment.empty() || segment.size() > 18 || (segment[0] == '0' && segment.size() > 1))
+		return (JsonPath::npos);
+	size_t	index = 0;
+	for (char c : segment) {
+		if (c < '0' || c > '9')
+			return (JsonPath::npos);
+		index = index * 10 + size_t(c - '0');
+	}
+	return (index);
+}
+
+JsonPath::JsonPath(StringRef pointer) : pointer(pointer.str()) {
+	if (pointer.empty())
+		return ;
+	if (pointer[0] != '/')
+		throw(Json::json_exception("invalid JSON pointer, doesn't start with '/': " + this->pointer));
+
+	std::string	segment;
+	for (size_t i = 1; i <= pointer.size(); ++i) {
+		if (i == pointer.size() || pointer[i] == '/') {
+			segments.push_back(Segment{Key(segment), segment_index(segment)});
+			segment.clear();
+			continue ;
+		}
+		if (pointer[i] != '~') {
+			segment.push_back(pointer[i]);
+			continue ;
+		}
+		// ~0 is '~', ~1 is '/'
+		if (i + 1 == pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+			throw(Json::json_exception("invalid JSON pointer, bad '~' escape: " + this->pointer));
+		segment.push_back(pointer[++i] == '0' ? '~' : '/');
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Evaluation                                 */
+/* -------------------------------------------------------------------------- */
+
+Json& JsonPath::find(Json& root) const {
+	Json*	node = &root;
+
+	for (Segment const& segment : segments) {
+		switch (node->get_type()) {
+			case Json::OBJECT : {
+				Json::object&	obj = node->get<Json::object>();
+				auto			it = obj.find(segment.key, segment.key.hash());
+				if (it == obj.end())
+					return (Json::missing_ref());
+				node = &it->second;
+				break ;
+			}
+			case Json::ARRAY : {
+				Json::array&	arr = node->get<Json::array>();
+				if (segment.index >= arr.size())
+					return (Json::missing_ref());
+				node = &arr[segment.index];
+				break ;
+			}
+			default :
+				return (Json::missing_ref());
+		}
+	}
+	return (*node);
+}
+
+Json const& JsonPath::find(Json const& root) const {
+	return (find(const_cast<Json&>(root)));
+}
+
+} // namespace njson
@@ -0,0 +1,29 @@
+#ifndef NJSON_POWER_TABLE_H
+# define NJSON_POWER_TABLE_H
+
+# include <cstdint>
+
+namespace njson {
+
+// range of decimal exponents covered by power_of_five_128
+static const int	smallest_power_of_five = -342;
+static const int	largest_power_of_five = 308;
+
+// two words per power: power_of_five_128[2 * (q - smallest_power_of_five)] is the high word of 5^q
+extern const uint64_t	power_of_five_128[];
+
+// 10^k ~= f * 2^e, with f normalized (top bit set)
+struct CachedPower {
+	uint64_t	f;
+	int			e;
+	int			k;
+};
+
+static const int	cached_powers_min_exponent = -300;
+static const int	cached_powers_step = 8;
+
+extern const CachedPower	cached_powers_of_ten[];
+
+} // namespace njson
+
+#endif // NJSON_POWER_TABLE_H
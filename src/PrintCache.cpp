@@ -0,0 +1,245 @@
+#include "njson/print_cache.h"
+
+#include <unordered_map>
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                Construction                                */
+/* -------------------------------------------------------------------------- */
+
+JsonPrintCache::JsonPrintCache(Json const& root, bool pretty, size_t chunk_size)
+	: root(root)
+	, writer(pretty)
+	, chunk_size(chunk_size) {}
+
+// the children are destroyed from a list, assembled fragments can be nested as deep as the tree
+JsonPrintCache::Fragment::~Fragment() {
+	if (children.empty())
+		return ;
+	std::vector<Fragment>	pending;
+	pending.swap(children);
+	while (!pending.empty()) {
+		Fragment	last(std::move(pending.back()));
+		pending.pop_back();
+		for (Fragment& child : last.children)
+			pending.push_back(std::move(child));
+		last.children.clear();
+	}
+}
+
+// an invalid fragment keeps its key, it still belongs to the same member
+void JsonPrintCache::Fragment::reset(void) {
+	state = INVALID;
+	std::string().swap(bytes);
+	std::vector<Fragment>().swap(children);
+}
+
+void JsonPrintCache::clear(void) {
+	tree.reset();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Invalidation                                */
+/* -------------------------------------------------------------------------- */
+
+/*
+	Follows the path down the assembled fragments and drops the fragment
+	the value is part of. A value that was added or removed has no
+	fragment or no value, its container finds out when it's written.
+*/
+void JsonPrintCache::invalidate(JsonPath const& path) {
+	Fragment*	fragment = &tree;
+	Json const*	json = &root;
+
+	for (size_t i = 0; i < path.size() && fragment->state == Fragment::ASSEMBLED; ++i) {
+		std::vector<Fragment>&	children = fragment->children;
+		Fragment*				child = nullptr;
+		Json const*				value = nullptr;
+
+		if (json->get_type() == Json::OBJECT) {
+			Key const&				key = path.key(i);
+			Json::object const&		obj = json->get<Json::object>();
+			auto					it = obj.find(key, key.hash());
+			if (it != obj.end()) {
+				value = &it->second;
+				size_t	pos = it - obj.begin();
+				if (pos < children.size() && children[pos].key == key)
+					child = &children[pos];
+			}
+			for (size_t c = 0; child == nullptr && c < children.size(); ++c)
+				if (children[c].key == key)
+					child = &children[c];
+		} else if (json->get_type() == Json::ARRAY) {
+			Json::array const&	arr = json->get<Json::array>();
+			size_t				index = path.index(i);
+			if (index < children.size())
+				child = &children[index];
+			if (index < arr.size())
+				value = &arr[index];
+		}
+		if (child == nullptr || value == nullptr)
+			return ;
+		fragment = child;
+		json = value;
+	}
+	fragment->reset();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Output                                   */
+/* -------------------------------------------------------------------------- */
+
+// without recursion, the containers above the one being written wait on the stack
+std::string const& JsonPrintCache::str(void) {
+	writer.clear();
+	write(root, 0, tree, false);
+	while (!open.empty()) {
+		OpenFragment&			container = open.back();
+		std::vector<Fragment>&	children = container.fragment->children;
+		size_t					depth = container.depth;
+		bool					builds = container.builds;
+		if (container.json->get_type() == Json::ARRAY) {
+			Json::array const&	arr = container.json->get<Json::array>();
+			if (container.next > 0)
+				writer.end_element(container.next == arr.size());
+			if (container.next == arr.size()) {
+				writer.end_array(depth);
+				OpenFragment	closed = container;
+				open.pop_back();
+				end(closed);
+				continue ;
+			}
+			size_t	i = container.next++;
+			writer.begin_element(depth);
+			write(arr[i], depth + 1, children[i], builds);
+		} else {
+			Json::object const&	obj = container.json->get<Json::object>();
+			if (container.next > 0)
+				writer.end_member(container.next == obj.size());
+			if (container.next == obj.size()) {
+				writer.end_object(depth);
+				OpenFragment	closed = container;
+				open.pop_back();
+				end(closed);
+				continue ;
+			}
+			size_t		i = container.next++;
+			auto const&	member = obj.begin()[i];
+			writer.begin_member(member.first, depth);
+			write(member.second, depth + 1, children[i], builds);
+		}
+	}
+	return (writer.str());
+}
+
+void JsonPrintCache::print(std::ostream& out) {
+	std::string const&	output = str();
+	out.write(output.data(), output.size());
+	out << std::endl;
+}
+
+/*
+	Writes a value, or the start of a container that is then opened.
+	building: the parent of the fragment is being built and may become
+	one fragment with it. An invalid value is built: its children are
+	written as pending fragments, and when the whole value fits in a
+	chunk it's one pending fragment itself and its children are dropped,
+	otherwise it's assembled from them.
+*/
+void JsonPrintCache::write(Json const& json, size_t depth, Fragment& fragment, bool building) {
+	bool	container = json.get_type() == Json::OBJECT || json.get_type() == Json::ARRAY;
+	if (fragment.state == Fragment::ASSEMBLED && !container)
+		fragment.reset();
+
+	OpenFragment	value = {&json, &fragment, depth, 0, writer.buffer.size(), building,
+		fragment.state != Fragment::CACHED && fragment.state != Fragment::ASSEMBLED};
+	if (fragment.state == Fragment::CACHED) {
+		writer.buffer.append(fragment.bytes);
+	} else if (!container) {
+		writer.write_tree(json, depth);
+	} else if (begin(json, depth, fragment)) {
+		open.push_back(value);
+		return ;
+	}
+	end(value);
+}
+
+// the start of a container, with a fragment per child (false if it's empty and written whole)
+bool JsonPrintCache::begin(Json const& json, size_t depth, Fragment& fragment) {
+	if (json.get_type() == Json::OBJECT) {
+		Json::object const&	obj = json.get<Json::object>();
+		bool				matched = fragment.children.size() == obj.size();
+		size_t				i = 0;
+		for (auto it = obj.begin(); matched && it != obj.end(); ++it, ++i)
+			matched = fragment.children[i].key == it->first;
+		if (!matched)
+			match_members(obj, fragment);
+		return (writer.begin_object(obj.size()));
+	}
+	// elements are matched by position
+	Json::array const&	arr = json.get<Json::array>();
+	if (fragment.children.size() != arr.size())
+		fragment.children.resize(arr.size());
+	return (writer.begin_array(arr.size(), depth));
+}
+
+// a value is written, containers after they're closed
+void JsonPrintCache::end(OpenFragment const& value) {
+	if (value.builds)
+		build(*value.fragment, value.start);
+	if (!value.building)
+		keep(*value.fragment);
+}
+
+// a built value becomes one pending fragment, or is assembled from its children when it's too large
+void JsonPrintCache::build(Fragment& fragment, size_t start) {
+	fragment.start = start;
+	fragment.size = writer.buffer.size() - start;
+	if (fragment.size <= chunk_size || fragment.children.empty()) {
+		fragment.state = Fragment::PENDING;
+		std::vector<Fragment>().swap(fragment.children);
+		return ;
+	}
+	fragment.state = Fragment::ASSEMBLED;
+	for (Fragment& child : fragment.children)
+		keep(child);
+}
+
+void JsonPrintCache::keep(Fragment& child) {
+	if (child.state != Fragment::PENDING)
+		return ;
+	child.bytes.assign(writer.buffer, child.start, child.size);
+	child.state = Fragment::CACHED;
+}
+
+namespace {
+
+struct KeyRefHash {
+	size_t	operator()(StringRef key) const { return (Key::hash(key.data(), key.size())); }
+};
+
+} // namespace
+
+// members that are still there keep their fragment, new members get an invalid one
+void JsonPrintCache::match_members(Json::object const& obj, Fragment& fragment) {
+	std::vector<Fragment>	old;
+	old.swap(fragment.children);
+
+	std::unordered_map<StringRef, size_t, KeyRefHash>	positions;
+	for (size_t i = 0; i < old.size(); ++i)
+		positions.emplace(old[i].key.ref(), i);
+
+	fragment.children.resize(obj.size());
+	size_t	i = 0;
+	for (auto const& member : obj) {
+		Fragment&	child = fragment.children[i++];
+		auto		it = positions.find(member.first.ref());
+		if (it != positions.end())
+			child = std::move(old[it->second]);
+		else
+			child.key = member.first;
+	}
+}
+
+} // namespace njson
@@ -0,0 +1,342 @@
+#include "njson/njson.h"
+#include "njson/number.h"
+#include "PushParser.h"
+#include "Unescape.h"
+
+#include <cstring>
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                Construction                                */
+/* -------------------------------------------------------------------------- */
+
+// the push state keeps the arena alive while building, the nodes keep it alive afterwards
+static Arena*	make_arena(bool use) {
+	if (!use) {
+		return (nullptr);
+	}
+	Arena*	arena = new Arena();
+	arena->retain();
+	return (arena);
+}
+
+JsonParser::PushState::PushState(JsonParser& parser)
+: parser(parser), arena(make_arena(parser.use_arena)), builder(arena, keys, parser.intern_keys, stacks),
+expect(VALUE), is_key(false), is_number(false), escape(false), escaped(false) {
+	if (parser.intern_keys) {
+		keys.reset(arena);
+	}
+	builder.set_schema(parser.key_schema.get());
+}
+
+JsonParser::PushState::~PushState() {
+	keys.reset(nullptr);
+	if (arena != nullptr) {
+		arena->share();
+		arena->release();
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Structure                                 */
+/* -------------------------------------------------------------------------- */
+
+bool JsonParser::PushState::feed(char const* p, char const* end) {
+	while (p < end) {
+		if (expect == STRING) {
+			if (!continue_string(p, end)) {
+				return (false);
+			}
+			continue ;
+		}
+		if (expect == TOKEN) {
+			if (!continue_token(p, end)) {
+				return (false);
+			}
+			continue ;
+		}
+
+		char	c = *p++;
+		if (is_space(c)) {
+			continue ;
+		}
+		switch (expect) {
+			case FIRST_VALUE :
+				if (c == ']') {
+					if (!close_container()) {
+						return (false);
+					}
+					break ;
+				}
+				// fall through
+			case VALUE :
+				if (!start_value(c, p, end)) {
+					return (false);
+				}
+				break ;
+
+			case FIRST_KEY :
+				if (c == '}') {
+					if (!close_container()) {
+						return (false);
+					}
+					break ;
+				}
+				// fall through
+			case KEY :
+				if (c != '\"') {
+					if (is_delimiter(c)) {
+						return (parser.set_error(std::string{"bad object, unexpected token: '"} + c + '\''));
+					}
+					return (parser.set_error("bad object, key not encapsulated by quotes"));
+				}
+				is_key = true;
+				expect = STRING;
+				token.clear();
+				escape = false;
+				escaped = false;
+				break ;
+
+			case COLON :
+				if (c != ':') {
+					return (parser.set_error("bad object, key not followed by ':'"));
+				}
+				expect = VALUE;
+				break ;
+
+			case NEXT :
+				if (c == stack.back().close) {
+					if (!close_container()) {
+						return (false);
+					}
+					break ;
+				}
+				if (c != ',') {
+					if (stack.back().close == '}') {
+						return (parser.set_error("bad object, elements not seperated by ','"));
+					}
+					return (parser.set_error("bad array, elements not seperated by ','"));
+				}
+				expect = (stack.back().close == '}') ? KEY : VALUE;
+				break ;
+
+			case DONE :
+			default :
+				return (parser.set_error("unexpected data after the document"));
+		}
+	}
+	return (true);
+}
+
+// c is the first character of the value, p is just past it
+bool JsonParser::PushState::start_value(char c, char const*& p, char const* end) {
+	if ((c == '{' || c == '[') && stack.size() >= parser.max_depth) {
+		return (parser.set_error("document too deep, nested more than " + std::to_string(parser.max_depth) + " levels"));
+	}
+	switch (c) {
+		case '{' :
+			stack.push_back(Container{'}', 0});
+			expect = FIRST_KEY;
+			return (builder.on_object_start());
+		case '[' :
+			stack.push_back(Container{']', 0});
+			expect = FIRST_VALUE;
+			return (builder.on_array_start());
+		case '\"' :
+			is_key = false;
+			expect = STRING;
+			token.clear();
+			escape = false;
+			escaped = false;
+			return (continue_string(p, end));
+		default :
+			break ;
+	}
+	if (is_delimiter(c)) {
+		// a delimiter where a value was expected
+		return (parser.set_error(std::string{"unrecognized token: "} + c));
+	}
+	is_number = (c == '-' || (c >= '0' && c <= '9'));
+	expect = TOKEN;
+	token.clear();
+	--p;
+	return (continue_token(p, end));
+}
+
+bool JsonParser::PushState::close_container(void) {
+	Container	closed = stack.back();
+	stack.pop_back();
+	if (closed.close == '}') {
+		builder.on_object_end(closed.count);
+	} else {
+		builder.on_array_end(closed.count);
+	}
+	return (value_done());
+}
+
+bool JsonParser::PushState::value_done(void) {
+	if (stack.empty()) {
+		expect = DONE;
+		return (true);
+	}
+	++stack.back().count;
+	expect = NEXT;
+	return (true);
+}
+
+bool JsonParser::PushState::finish(void) {
+	if (expect == TOKEN && !end_token(token.data(), token.data() + token.size())) {
+		return (false);
+	}
+	if (expect == STRING) {
+		return (parser.set_error("string not encapsulated by '\"'"));
+	}
+	if (expect == COLON) {
+		return (parser.set_error("bad object, key not followed by ':'"));
+	}
+	if (!stack.empty()) {
+		if (stack.back().close == '}') {
+			return (parser.set_error("object not closed by '}'"));
+		}
+		return (parser.set_error("array not closed by ']'"));
+	}
+	return (true);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Tokens                                   */
+/* -------------------------------------------------------------------------- */
+
+// p is inside the string (past the opening quote), consumes the chunk up to the closing quote
+bool JsonParser::PushState::continue_string(char const*& p, char const* end) {
+	// a string that lies within the chunk and has no escapes is read in place
+	if (token.empty() && !escape) {
+		char const*	quote = static_cast<char const*>(std::memchr(p, '\"', end - p));
+		if (quote != nullptr && std::memchr(p, '\\', quote - p) == nullptr) {
+			StringRef	str(p, quote - p);
+			p = quote + 1;
+			return (end_string(str));
+		}
+	}
+
+	char const*	run = p;
+	while (p < end) {
+		char	c = *p++;
+		if (escape) {
+			escape = false;
+			continue ;
+		}
+		if (c == '\\') {
+			escape = true;
+			escaped = true;
+		} else if (c == '\"') {
+			token.append(run, p - 1 - run);
+			return (end_string(StringRef(token)));
+		}
+	}
+	token.append(run, p - run);
+	return (true);
+}
+
+bool JsonParser::PushState::end_string(StringRef str) {
+	if (escaped) {
+		parser.string_buffer.clear();
+		if (unescape_string(str.data(), str.data() + str.size(), parser.string_buffer) == nullptr) {
+			return (parser.set_error("bad escape sequence in string"));
+		}
+		str = StringRef(parser.string_buffer);
+	}
+	if (is_key) {
+		expect = COLON;
+		return (builder.on_key(str));
+	}
+	return (builder.on_string(str) && value_done());
+}
+
+// p is inside a number or word, consumes the chunk up to the end of the token
+bool JsonParser::PushState::continue_token(char const*& p, char const* end) {
+	char const*	last = p;
+	while (last < end && !is_delimiter(*last) && !is_space(*last) && *last != '\"') {
+		++last;
+	}
+	if (last == end) {
+		token.append(p, last);
+		p = end;
+		return (true);
+	}
+
+	// the token ends in this chunk
+	char const*	begin = p;
+	p = last;
+	if (token.empty()) {
+		return (end_token(begin, last));
+	}
+	token.append(begin, last);
+	return (end_token(token.data(), token.data() + token.size()));
+}
+
+bool JsonParser::PushState::end_token(char const* begin, char const* end) {
+	if (is_number) {
+		Json::number_int	_int;
+		Json::number_float	_float;
+		bool				is_float;
+		char const*			p = begin;
+
+		// the whole token has to be the number
+		if (!parse_number(p, end, _int, _float, is_float) || p != end) {
+			return (parser.set_error("invalid number: " + std::string(begin, end)));
+		}
+		if (is_float) {
+			builder.on_double(_float);
+		} else {
+			builder.on_int(_int);
+		}
+		return (value_done());
+	}
+
+	size_t	len = end - begin;
+	if (len == 4 && std::memcmp(begin, "true", 4) == 0) {
+		builder.on_bool(true);
+	} else if (len == 5 && std::memcmp(begin, "false", 5) == 0) {
+		builder.on_bool(false);
+	} else if (len == 4 && std::memcmp(begin, "null", 4) == 0) {
+		builder.on_null();
+	} else {
+		return (parser.set_error("unrecognized token: " + std::string(begin, end)));
+	}
+	return (value_done());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 JsonParser                                 */
+/* -------------------------------------------------------------------------- */
+
+bool JsonParser::feed(char const* data, size_t size) {
+	if (error) {
+		return (false);
+	}
+	if (!push) {
+		push.reset(new PushState(*this));
+	}
+	return (push->feed(data, data + size));
+}
+
+Json::pointer_t JsonParser::finish(void) {
+	if (!push) {
+		// nothing was fed
+		return (Json::null_ptr());
+	}
+
+	Json::pointer_t	root;
+	if (!error && push->finish()) {
+		root = push->release();
+	}
+	push.reset();
+	if (!root) {
+		return (Json::null_ptr());
+	}
+	return (root);
+}
+
+} // namespace njson
@@ -0,0 +1,84 @@
+#ifndef NJSON_PUSH_PARSER_H
+# define NJSON_PUSH_PARSER_H
+
+# include <string>
+# include <vector>
+
+# include "njson/njson.h"
+# include "DomBuilder.h"
+
+namespace njson {
+
+/*
+	Resumable parser behind JsonParser::feed(). Instead of the call stack
+	of the recursive parser it keeps what it expects next and a stack of
+	open containers, so it can stop at the end of any chunk and continue
+	with the next one. Strings, numbers and words that are split between
+	chunks are collected in a token buffer, tokens that lie within one
+	chunk are read from the chunk directly.
+
+	It reports the same errors as parse() does for the same input.
+*/
+class JsonParser::PushState
+{
+	public:
+		PushState(JsonParser& parser);
+		~PushState();
+
+		PushState(PushState const& other) = delete;
+		PushState& operator=(PushState const& other) = delete;
+
+		bool feed(char const* p, char const* end);
+
+		// completes a pending token and checks that the document is complete
+		bool finish(void);
+
+		Json::pointer_t release(void) { return (builder.release()); }
+
+	private:
+		enum Expect {
+			VALUE,			// any value
+			FIRST_VALUE,	// a value or ']' (just after '[')
+			KEY,			// an object key
+			FIRST_KEY,		// an object key or '}' (just after '{')
+			COLON,			// ':' after a key
+			NEXT,			// ',' or the end of the container after a value
+			STRING,			// inside a string (key or value)
+			TOKEN,			// inside a number or word
+			DONE			// the document is complete
+		};
+
+		struct Container {
+			char	close;	// '}' or ']'
+			size_t	count;	// values so far
+		};
+
+		bool start_value(char c, char const*& p, char const* end);
+		bool close_container(void);
+		bool value_done(void);
+
+		bool continue_string(char const*& p, char const* end);
+		bool end_string(StringRef str);
+		bool continue_token(char const*& p, char const* end);
+		bool end_token(char const* begin, char const* end);
+
+		JsonParser&				parser;
+		Arena*					arena;
+		KeyPool					keys;
+		BuildStacks				stacks;
+		DomBuilder				builder;
+
+		Expect					expect;
+		std::vector<Container>	stack;
+
+		// the partial token, for strings without the quotes and undecoded
+		std::string				token;
+		bool					is_key;		// the string is an object key
+		bool					is_number;	// the token is a number (a word otherwise)
+		bool					escape;		// the string so far ends in an unfinished backslash
+		bool					escaped;	// the string contains escapes
+};
+
+} // namespace njson
+
+#endif // NJSON_PUSH_PARSER_H
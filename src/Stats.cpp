@@ -0,0 +1,85 @@
+#include "Stats.h"
+
+#include <algorithm>
+
+#ifdef NJSON_STATS
+
+namespace njson {
+
+static thread_local StatsCollector*	active_collector = nullptr;
+
+/* -------------------------------------------------------------------------- */
+/*                                  Collector                                 */
+/* -------------------------------------------------------------------------- */
+
+StatsCollector::StatsCollector(ParseStats& stats, char const* const& cursor, size_t depth)
+: stats(stats), depth(depth), outer(active_collector),
+start(now()), paused(0), started(std::chrono::steady_clock::now()), cursor(cursor), first(nullptr) {
+	active_collector = this;
+}
+
+StatsCollector::~StatsCollector() {
+	uint64_t	ticks = now() - start;
+	std::chrono::duration<double>	elapsed = std::chrono::steady_clock::now() - started;
+
+	// the ticks are converted with the rate of the clock measured over the parse
+	double	seconds_per_tick = ticks > 0 ? elapsed.count() / double(ticks) : 0;
+	double	own = double(ticks - paused);
+	double	phases = number.estimate() + build.estimate();
+	stats.total_seconds += elapsed.count();
+	stats.number_seconds += number.estimate() * seconds_per_tick;
+	stats.build_seconds += build.estimate() * seconds_per_tick;
+	stats.tokenize_seconds += (own > phases ? own - phases : 0) * seconds_per_tick;
+	if (first != nullptr)
+		stats.bytes += cursor - first;
+
+	active_collector = outer;
+	if (outer != nullptr)
+		outer->paused += ticks;
+}
+
+StatsCollector*	StatsCollector::active(void) {
+	return (active_collector);
+}
+
+static uint64_t	measure_overhead(void) {
+	uint64_t	least = ~uint64_t(0);
+	for (int i = 0; i < 64; ++i) {
+		uint64_t	start = StatsCollector::now();
+		least = std::min(least, StatsCollector::now() - start);
+	}
+	return (least);
+}
+
+uint64_t	StatsCollector::overhead(void) {
+	static const uint64_t	ticks = measure_overhead();
+	return (ticks);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Hooks                                   */
+/* -------------------------------------------------------------------------- */
+
+void	stats_allocation(size_t bytes) {
+	if (active_collector != nullptr) {
+		++active_collector->stats.allocations;
+		active_collector->stats.allocated_bytes += bytes;
+	}
+}
+
+void	merge_stats(ParseStats& into, ParseStats const& other) {
+	for (size_t i = 0; i < sizeof(into.nodes) / sizeof(*into.nodes); ++i)
+		into.nodes[i] += other.nodes[i];
+	if (other.max_depth > into.max_depth)
+		into.max_depth = other.max_depth;
+	into.string_bytes += other.string_bytes;
+	into.allocations += other.allocations;
+	into.allocated_bytes += other.allocated_bytes;
+	into.tokenize_seconds += other.tokenize_seconds;
+	into.number_seconds += other.number_seconds;
+	into.build_seconds += other.build_seconds;
+}
+
+} // namespace njson
+
+#endif // NJSON_STATS
@@ -0,0 +1,226 @@
+#ifndef NJSON_STATS_INTERNAL_H
+# define NJSON_STATS_INTERNAL_H
+
+# include "njson/stats.h"
+
+# ifdef NJSON_STATS
+
+#  include <chrono>
+#  include <cstdint>
+#  if defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#  endif
+
+#  include "njson/njson.h"
+#  include "njson/string_ref.h"
+
+namespace njson {
+
+/*
+	Time spent in one phase of the parse. Reading the clock around every
+	call would cost more than most calls, so only a random sample of
+	about one in 16 calls is timed and their total is estimated from it.
+	Calls that can take long (closing a large container) are always
+	timed, a sample would miss them or count them 16 times.
+*/
+struct StatsPhase {
+	StatsPhase() : ticks(0), calls(0), sampled(0), exact(0), countdown(1), random(0x9E3779B9u) {}
+
+	// true when this call is timed
+	bool sample(void) {
+		++calls;
+		if (--countdown != 0)
+			return (false);
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		countdown = 1 + (random & 31);
+		return (true);
+	}
+
+	double estimate(void) const {
+		return (double(exact) + (sampled > 0 ? double(ticks) * double(calls) / double(sampled) : 0));
+	}
+
+	uint64_t	ticks;		// of the sampled calls
+	uint64_t	calls;
+	uint64_t	sampled;
+	uint64_t	exact;		// of the calls that are always timed
+	uint32_t	countdown;	// calls until the next sample
+	uint32_t	random;
+};
+
+/*
+	Collects the ParseStats of one parse() on the current thread. While
+	it exists it's the active collector of the thread, which the
+	allocation hooks and the number conversion report to. Times are
+	kept in ticks of a cheap clock and converted when the parse ends.
+	A collector that is created while another is active (a parse() on
+	several threads that works on the calling thread too) pauses the
+	outer one, so no time is counted twice.
+*/
+class StatsCollector
+{
+	public:
+		// cursor is the parse position, depth the nesting of the values that are parsed
+		StatsCollector(ParseStats& stats, char const* const& cursor, size_t depth = 0);
+		~StatsCollector();
+
+		StatsCollector(StatsCollector const& other) = delete;
+		StatsCollector& operator=(StatsCollector const& other) = delete;
+
+		// the collector of the parse running on this thread, null if none
+		static StatsCollector*	active(void);
+
+		// the time stamp counter where there is one, it's a lot cheaper than reading a clock
+		static uint64_t	now(void) {
+#  if defined(__x86_64__) || defined(__i386__)
+			return (__rdtsc());
+#  else
+			return (uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count()));
+#  endif
+		}
+
+		// ticks that reading the clock adds to a measurement
+		static uint64_t	overhead(void);
+
+		// the consumed input is counted from the cursor at this point
+		void	start_input(void) { first = cursor; }
+
+		ParseStats&	stats;
+		size_t		depth;		// of the value being parsed
+		StatsPhase	number;
+		StatsPhase	build;
+
+	private:
+		StatsCollector*							outer;
+		uint64_t								start;
+		uint64_t								paused;	// ticks of nested collectors
+		std::chrono::steady_clock::time_point	started;
+		char const* const&						cursor;
+		char const*								first;
+};
+
+// times the call it lives through when the phase samples it (or always), does nothing without a phase
+class StatsTimer
+{
+	public:
+		explicit StatsTimer(StatsPhase* phase, bool always = false)
+		: phase(phase != nullptr && (always || phase->sample()) ? phase : nullptr), always(always),
+		start(this->phase ? StatsCollector::now() : 0) {}
+
+		~StatsTimer() {
+			if (phase == nullptr)
+				return ;
+			uint64_t	ticks = StatsCollector::now() - start;
+			ticks = ticks > StatsCollector::overhead() ? ticks - StatsCollector::overhead() : 0;
+			if (always) {
+				phase->exact += ticks;
+			} else {
+				phase->ticks += ticks;
+				++phase->sampled;
+			}
+		}
+
+	private:
+		StatsPhase*	phase;
+		bool		always;
+		uint64_t	start;
+};
+
+// adds the stats of another thread of the same parse (the bytes and total time are the parse's own)
+void	merge_stats(ParseStats& into, ParseStats const& other);
+
+/*
+	Handler that counts the events of the parse and times the calls to
+	the handler it wraps, which is the time spent building the tree.
+*/
+template <typename Handler>
+class StatsHandler
+{
+	public:
+		StatsHandler(Handler& handler, StatsCollector& collector)
+		: handler(handler), collector(collector), stats(collector.stats) {}
+
+		bool on_null(void) {
+			StatsTimer	timer(&collector.build);
+			++stats.nodes[Json::NULL_T];
+			return (handler.on_null());
+		}
+
+		bool on_bool(bool b) {
+			StatsTimer	timer(&collector.build);
+			++stats.nodes[Json::BOOL];
+			return (handler.on_bool(b));
+		}
+
+		bool on_int(Json::number_int i) {
+			StatsTimer	timer(&collector.build);
+			++stats.nodes[Json::NUMBER_INT];
+			return (handler.on_int(i));
+		}
+
+		bool on_double(Json::number_float f) {
+			StatsTimer	timer(&collector.build);
+			++stats.nodes[Json::NUMBER_FLOAT];
+			return (handler.on_double(f));
+		}
+
+		bool on_string(StringRef str) {
+			StatsTimer	timer(&collector.build);
+			++stats.nodes[Json::STRING];
+			stats.string_bytes += str.size();
+			return (handler.on_string(str));
+		}
+
+		bool on_key(StringRef str) {
+			StatsTimer	timer(&collector.build);
+			stats.string_bytes += str.size();
+			return (handler.on_key(str));
+		}
+
+		bool on_object_start(void) {
+			StatsTimer	timer(&collector.build);
+			open(Json::OBJECT);
+			return (handler.on_object_start());
+		}
+
+		bool on_array_start(void) {
+			StatsTimer	timer(&collector.build);
+			open(Json::ARRAY);
+			return (handler.on_array_start());
+		}
+
+		bool on_object_end(size_t count) {
+			StatsTimer	timer(&collector.build, count >= large_container);
+			--collector.depth;
+			return (handler.on_object_end(count));
+		}
+
+		bool on_array_end(size_t count) {
+			StatsTimer	timer(&collector.build, count >= large_container);
+			--collector.depth;
+			return (handler.on_array_end(count));
+		}
+
+	private:
+		// closing containers of this many values is always timed
+		static const size_t	large_container = 16;
+
+		void open(Json::Type type) {
+			++stats.nodes[type];
+			if (++collector.depth > stats.max_depth)
+				stats.max_depth = collector.depth;
+		}
+
+		Handler&		handler;
+		StatsCollector&	collector;
+		ParseStats&		stats;
+};
+
+} // namespace njson
+
+# endif // NJSON_STATS
+
+#endif // NJSON_STATS_INTERNAL_H
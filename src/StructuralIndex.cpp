@@ -0,0 +1,306 @@
+#include "StructuralIndex.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define NJSON_X86_KERNELS 1
+# include <immintrin.h>
+#endif
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                 Block logic                                */
+/* -------------------------------------------------------------------------- */
+
+//	one bit per byte of a 64-byte block
+struct BlockMasks {
+	uint64_t	op;			// { } [ ] : ,
+	uint64_t	ws;			// whitespace
+	uint64_t	quote;		// "
+	uint64_t	backslash;	// '\'
+};
+
+//	state carried from one block into the next
+struct IndexState {
+	uint64_t	prev_escaped;	// first byte of the block is escaped
+	uint64_t	prev_in_string;	// all ones if the previous block ended inside a string
+	uint64_t	prev_scalar;	// last byte of the previous block was part of a bare token
+};
+
+//	bit i of the result is the xor of bits 0..i
+static inline uint64_t	prefix_xor(uint64_t x) {
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return (x);
+}
+
+//	characters preceded by an odd number of backslashes
+static inline uint64_t	find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+	const uint64_t	even_bits = 0x5555555555555555ULL;
+
+	backslash &= ~prev_escaped;
+	uint64_t	follows_escape = (backslash << 1) | prev_escaped;
+	uint64_t	odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+	unsigned long long	sequences_starting_on_even_bits;
+	prev_escaped = __builtin_uaddll_overflow(odd_sequence_starts, backslash, &sequences_starting_on_even_bits);
+	uint64_t	invert_mask = uint64_t(sequences_starting_on_even_bits) << 1;
+	return ((even_bits ^ invert_mask) & follows_escape);
+}
+
+//	returns the token starts of the block
+static inline uint64_t	find_structurals(BlockMasks const& m, IndexState& state) {
+	uint64_t	escaped = find_escaped(m.backslash, state.prev_escaped);
+	uint64_t	quote = m.quote & ~escaped;
+
+	// in_string covers the opening quote up to (not including) the closing quote
+	uint64_t	in_string = prefix_xor(quote) ^ state.prev_in_string;
+	state.prev_in_string = uint64_t(int64_t(in_string) >> 63);
+	uint64_t	string_tail = in_string ^ quote;
+
+	// a bare token starts at a non-space, non-operator byte that doesn't follow one
+	uint64_t	scalar = ~(m.op | m.ws);
+	uint64_t	nonquote_scalar = scalar & ~quote;
+	uint64_t	follows_scalar = (nonquote_scalar << 1) | state.prev_scalar;
+	state.prev_scalar = nonquote_scalar >> 63;
+	uint64_t	scalar_start = scalar & ~follows_scalar;
+
+	// an opening quote always starts a token, even right after a bare token
+	return ((m.op | scalar_start | quote) & ~string_tail);
+}
+
+//	writes token offsets into the index, growing it ahead so a block never checks per bit
+struct IndexWriter {
+	std::vector<uint32_t>&	index;
+	uint32_t*				out;
+	uint32_t*				limit;
+
+	IndexWriter(std::vector<uint32_t>& index)
+	: index(index), out(index.data()), limit(index.data() + index.size()) {}
+	~IndexWriter() { index.resize(out - index.data()); }
+
+	void	grow(void) {
+		size_t	count = out - index.data();
+		index.resize(index.size() * 2 + 64);
+		out = index.data() + count;
+		limit = index.data() + index.size();
+	}
+
+	void	flatten(uint64_t bits, uint32_t base) {
+		// 64 entries of room, so the unrolled writes below may overshoot freely
+		if (limit - out < 64 + 8)
+			grow();
+
+		int	count = __builtin_popcountll(bits);
+		for (int i = 0; i < count; i += 4) {
+			out[i] = base + uint32_t(__builtin_ctzll(bits));
+			bits &= bits - 1;
+			out[i + 1] = base + uint32_t(__builtin_ctzll(bits | (uint64_t(1) << 63)));
+			bits &= bits - 1;
+			out[i + 2] = base + uint32_t(__builtin_ctzll(bits | (uint64_t(1) << 63)));
+			bits &= bits - 1;
+			out[i + 3] = base + uint32_t(__builtin_ctzll(bits | (uint64_t(1) << 63)));
+			bits &= bits - 1;
+		}
+		out += count;
+	}
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Kernels                                  */
+/* -------------------------------------------------------------------------- */
+
+typedef void	(*kernel_fn)(char const* data, size_t len, IndexWriter& writer);
+
+enum ByteClass {
+	CLASS_OP = 1,
+	CLASS_WS = 2,
+	CLASS_QUOTE = 4,
+	CLASS_BACKSLASH = 8
+};
+
+struct ClassTable {
+	uint8_t	table[256];
+
+	ClassTable() {
+		std::memset(table, 0, sizeof(table));
+		char const*	ops = "{}[]:,";
+		for (char const* c = ops; *c; ++c)
+			table[uint8_t(*c)] = CLASS_OP;
+		char const*	ws = " \t\n\r\v\f";
+		for (char const* c = ws; *c; ++c)
+			table[uint8_t(*c)] = CLASS_WS;
+		table[uint8_t('"')] = CLASS_QUOTE;
+		table[uint8_t('\\')] = CLASS_BACKSLASH;
+	}
+};
+
+static const ClassTable	class_table;
+
+//	the last partial block is padded with spaces
+static void	pad_block(char const* data, size_t len, size_t pos, char* block) {
+	std::memset(block, ' ', 64);
+	std::memcpy(block, data + pos, len - pos);
+}
+
+static void	index_scalar(char const* data, size_t len, IndexWriter& writer) {
+	IndexState	state = {0, 0, 0};
+	char		tail[64];
+
+	for (size_t pos = 0; pos < len; pos += 64) {
+		char const*	block = data + pos;
+		if (len - pos < 64) {
+			pad_block(data, len, pos, tail);
+			block = tail;
+		}
+
+		BlockMasks	m = {0, 0, 0, 0};
+		for (int i = 0; i < 64; ++i) {
+			uint64_t	bit = uint64_t(1) << i;
+			uint8_t		c = class_table.table[uint8_t(block[i])];
+			if (c & CLASS_OP) m.op |= bit;
+			if (c & CLASS_WS) m.ws |= bit;
+			if (c & CLASS_QUOTE) m.quote |= bit;
+			if (c & CLASS_BACKSLASH) m.backslash |= bit;
+		}
+		writer.flatten(find_structurals(m, state), uint32_t(pos));
+	}
+}
+
+#ifdef NJSON_X86_KERNELS
+
+__attribute__((target("sse2")))
+static inline void	classify_sse2(char const* p, uint64_t& op, uint64_t& ws, uint64_t& quote, uint64_t& backslash) {
+	__m128i	x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+
+	// '[' and ']' only differ from '{' and '}' in bit 5
+	__m128i	lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+	__m128i	o = _mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+		_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(':')), _mm_cmpeq_epi8(x, _mm_set1_epi8(','))));
+
+	// '\t' to '\r' are contiguous: (c - 9) <= 4 as unsigned
+	__m128i	shifted = _mm_sub_epi8(x, _mm_set1_epi8(9));
+	__m128i	w = _mm_or_si128(
+		_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+		_mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted));
+
+	op = uint64_t(uint16_t(_mm_movemask_epi8(o)));
+	ws = uint64_t(uint16_t(_mm_movemask_epi8(w)));
+	quote = uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')))));
+	backslash = uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\')))));
+}
+
+__attribute__((target("sse2")))
+static void	index_sse2(char const* data, size_t len, IndexWriter& writer) {
+	IndexState	state = {0, 0, 0};
+	char		tail[64];
+
+	for (size_t pos = 0; pos < len; pos += 64) {
+		char const*	block = data + pos;
+		if (len - pos < 64) {
+			pad_block(data, len, pos, tail);
+			block = tail;
+		}
+
+		BlockMasks	m = {0, 0, 0, 0};
+		for (int i = 0; i < 4; ++i) {
+			uint64_t	op, ws, quote, backslash;
+			classify_sse2(block + 16 * i, op, ws, quote, backslash);
+			m.op |= op << (16 * i);
+			m.ws |= ws << (16 * i);
+			m.quote |= quote << (16 * i);
+			m.backslash |= backslash << (16 * i);
+		}
+		writer.flatten(find_structurals(m, state), uint32_t(pos));
+	}
+}
+
+__attribute__((target("avx2")))
+static inline void	classify_avx2(char const* p, uint64_t& op, uint64_t& ws, uint64_t& quote, uint64_t& backslash) {
+	__m256i	x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+
+	__m256i	lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+	__m256i	o = _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8(','))));
+
+	__m256i	shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(9));
+	__m256i	w = _mm256_or_si256(
+		_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+		_mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted));
+
+	op = uint64_t(uint32_t(_mm256_movemask_epi8(o)));
+	ws = uint64_t(uint32_t(_mm256_movemask_epi8(w)));
+	quote = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')))));
+	backslash = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\')))));
+}
+
+__attribute__((target("avx2")))
+static void	index_avx2(char const* data, size_t len, IndexWriter& writer) {
+	IndexState	state = {0, 0, 0};
+	char		tail[64];
+
+	for (size_t pos = 0; pos < len; pos += 64) {
+		char const*	block = data + pos;
+		if (len - pos < 64) {
+			pad_block(data, len, pos, tail);
+			block = tail;
+		}
+
+		BlockMasks	m = {0, 0, 0, 0};
+		for (int i = 0; i < 2; ++i) {
+			uint64_t	op, ws, quote, backslash;
+			classify_avx2(block + 32 * i, op, ws, quote, backslash);
+			m.op |= op << (32 * i);
+			m.ws |= ws << (32 * i);
+			m.quote |= quote << (32 * i);
+			m.backslash |= backslash << (32 * i);
+		}
+		writer.flatten(find_structurals(m, state), uint32_t(pos));
+	}
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                  Dispatch                                  */
+/* -------------------------------------------------------------------------- */
+
+struct Kernel {
+	kernel_fn	fn;
+	char const*	name;
+};
+
+static Kernel	select_kernel(void) {
+#ifdef NJSON_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return (Kernel {index_avx2, "avx2"});
+	if (__builtin_cpu_supports("sse2"))
+		return (Kernel {index_sse2, "sse2"});
+#endif
+	return (Kernel {index_scalar, "scalar"});
+}
+
+static Kernel const&	get_kernel(void) {
+	static const Kernel	kernel = select_kernel();
+	return (kernel);
+}
+
+void	build_structural_index(char const* data, size_t len, std::vector<uint32_t>& index) {
+	// typical documents have a token every few bytes
+	index.resize(len / 4 + 64);
+	IndexWriter	writer(index);
+	get_kernel().fn(data, len, writer);
+}
+
+char const*	structural_index_kernel(void) {
+	return (get_kernel().name);
+}
+
+} // namespace njson
@@ -0,0 +1,31 @@
+#ifndef NJSON_STRUCTURAL_INDEX_H
+# define NJSON_STRUCTURAL_INDEX_H
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+namespace njson {
+
+/*
+	First parsing pass: classifies the input 64 bytes at a time and
+	stores the offset of every token start, being the structural
+	characters ({}[]:,), the opening quote of every string and the first
+	character of every bare (number/word) token. Characters inside
+	strings (taking escapes into account) and whitespace are skipped.
+
+	The classification kernel (AVX2, SSE2 or scalar) is picked once at
+	runtime from the features of the CPU.
+*/
+
+// offsets are 32-bit, larger inputs are parsed without an index
+static const size_t	structural_index_max_size = size_t(0xFFFFFFFF);
+
+void		build_structural_index(char const* data, size_t len, std::vector<uint32_t>& index);
+
+// name of the kernel that build_structural_index() uses ("avx2", "sse2" or "scalar")
+char const*	structural_index_kernel(void);
+
+} // namespace njson
+
+#endif // NJSON_STRUCTURAL_INDEX_H
@@ -0,0 +1,283 @@
+#include "njson/tape.h"
+#include "njson/sax.h"
+
+#include <cstring>
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                  Building                                  */
+/* -------------------------------------------------------------------------- */
+
+void JsonTape::push_int(Json::number_int i) {
+	uint64_t	raw;
+	std::memcpy(&raw, &i, sizeof(raw));
+	tape.push_back(make_word(TAG_INT, 0));
+	tape.push_back(raw);
+}
+
+void JsonTape::push_float(Json::number_float f) {
+	uint64_t	raw;
+	std::memcpy(&raw, &f, sizeof(raw));
+	tape.push_back(make_word(TAG_FLOAT, 0));
+	tape.push_back(raw);
+}
+
+// strings are stored as a 32-bit length followed by the characters
+void JsonTape::push_string(char const* str, size_t len) {
+	uint32_t	len32 = uint32_t(len);
+	tape.push_back(make_word(TAG_STRING, strings.size()));
+	strings.append(reinterpret_cast<char const*>(&len32), sizeof(len32));
+	strings.append(str, len);
+}
+
+void JsonTape::close_container(size_t start, Tag end_tag, size_t count) {
+	tape.push_back(make_word(end_tag, start));
+	if (count > max_count)
+		count = max_count;
+	tape[start] = make_word(word_tag(tape[start]), (uint64_t(count) << 32) | tape.size());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Reading                                  */
+/* -------------------------------------------------------------------------- */
+
+JsonTape::Value JsonTape::root(void) const {
+	if (tape.empty())
+		return (Value());
+	return (Value(this, 0));
+}
+
+// index of the value after the one at idx
+size_t JsonTape::next(size_t idx) const {
+	uint64_t	word = tape[idx];
+	switch (word_tag(word)) {
+		case TAG_OBJECT :
+		case TAG_ARRAY :
+			return (size_t(word_payload(word) & 0xFFFFFFFF));
+		case TAG_INT :
+		case TAG_FLOAT :
+			return (idx + 2);
+		default :
+			return (idx + 1);
+	}
+}
+
+StringRef JsonTape::string_at(uint64_t offset) const {
+	uint32_t	len;
+	std::memcpy(&len, strings.data() + offset, sizeof(len));
+	return (StringRef(strings.data() + offset + sizeof(len), len));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Value                                   */
+/* -------------------------------------------------------------------------- */
+
+Json::Type JsonTape::Value::get_type(void) const {
+	if (tape == nullptr)
+		return (Json::NULL_T);
+	switch (word_tag(word())) {
+		case TAG_TRUE :
+		case TAG_FALSE :	return (Json::BOOL);
+		case TAG_INT :		return (Json::NUMBER_INT);
+		case TAG_FLOAT :	return (Json::NUMBER_FLOAT);
+		case TAG_STRING :	return (Json::STRING);
+		case TAG_OBJECT :	return (Json::OBJECT);
+		case TAG_ARRAY :	return (Json::ARRAY);
+		default :			return (Json::NULL_T);
+	}
+}
+
+void JsonTape::Value::check_tag(Json::Type type) const {
+	if (get_type() != type) {
+		throw(Json::json_exception("incorrect type. Expected: "
+			+ get_type_string()
+			+ ", given: "
+			+ Json::get_type_string(type)));
+	}
+}
+
+size_t JsonTape::Value::size(void) const {
+	Json::Type	type = get_type();
+	if (type != Json::ARRAY && type != Json::OBJECT)
+		return (0);
+
+	size_t	count = size_t(word_payload(word()) >> 32);
+	if (count < max_count)
+		return (count);
+
+	// saturated count, walk the container
+	count = 0;
+	if (type == Json::ARRAY) {
+		for (ArrayIterator it = begin_array(); it != end_array(); ++it)
+			++count;
+	} else {
+		for (ObjectIterator it = begin_object(); it != end_object(); ++it)
+			++count;
+	}
+	return (count);
+}
+
+JsonTape::Value JsonTape::Value::find(StringRef key) const {
+	if (get_type() != Json::OBJECT)
+		return (Value());
+	for (ObjectIterator it = begin_object(); it != end_object(); ++it) {
+		if (it.key() == key)
+			return (it.value());
+	}
+	return (Value());
+}
+
+JsonTape::Value JsonTape::Value::at(size_t index) const {
+	if (get_type() != Json::ARRAY)
+		return (Value());
+	for (ArrayIterator it = begin_array(); it != end_array(); ++it) {
+		if (index-- == 0)
+			return (*it);
+	}
+	return (Value());
+}
+
+// iterators of a value that isn't a container are empty
+JsonTape::ArrayIterator JsonTape::Value::begin_array(void) const {
+	if (get_type() != Json::ARRAY)
+		return (ArrayIterator(tape, 0));
+	return (ArrayIterator(tape, idx + 1));
+}
+
+JsonTape::ArrayIterator JsonTape::Value::end_array(void) const {
+	if (get_type() != Json::ARRAY)
+		return (ArrayIterator(tape, 0));
+	return (ArrayIterator(tape, tape->next(idx) - 1));
+}
+
+JsonTape::ObjectIterator JsonTape::Value::begin_object(void) const {
+	if (get_type() != Json::OBJECT)
+		return (ObjectIterator(tape, 0));
+	return (ObjectIterator(tape, idx + 1));
+}
+
+JsonTape::ObjectIterator JsonTape::Value::end_object(void) const {
+	if (get_type() != Json::OBJECT)
+		return (ObjectIterator(tape, 0));
+	return (ObjectIterator(tape, tape->next(idx) - 1));
+}
+
+Json::pointer_t JsonTape::Value::to_json(void) const {
+	return (Json::pointer_t(new Json(make_json())));
+}
+
+Json JsonTape::Value::make_json(void) const {
+	switch (get_type()) {
+		case Json::BOOL :			return (Json(get<bool>()));
+		case Json::NUMBER_INT :		return (Json(get<Json::number_int>()));
+		case Json::NUMBER_FLOAT :	return (Json(get<Json::number_float>()));
+		case Json::STRING :			return (Json(get<Json::string>()));
+		case Json::ARRAY : {
+			Json::array	elements;
+			elements.reserve(size());
+			for (ArrayIterator it = begin_array(); it != end_array(); ++it)
+				elements.push_back((*it).make_json());
+			return (Json(std::move(elements)));
+		}
+		case Json::OBJECT : {
+			Json::object	members;
+			members.reserve(size());
+			for (ObjectIterator it = begin_object(); it != end_object(); ++it)
+				members.emplace(Key(it.key()), it.value().make_json());
+			return (Json(std::move(members)));
+		}
+		default :
+			return (Json());
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   is/get                                   */
+/* -------------------------------------------------------------------------- */
+
+template<> bool JsonTape::Value::is<Json::null_t>(void) const { return get_type() == Json::NULL_T; }
+template<> bool JsonTape::Value::is<Json::array>(void) const { return get_type() == Json::ARRAY; }
+template<> bool JsonTape::Value::is<Json::object>(void) const { return get_type() == Json::OBJECT; }
+template<> bool JsonTape::Value::is<Json::string>(void) const { return get_type() == Json::STRING; }
+template<> bool JsonTape::Value::is<StringRef>(void) const { return get_type() == Json::STRING; }
+template<> bool JsonTape::Value::is<Json::number_float>(void) const { return get_type() == Json::NUMBER_FLOAT; }
+template<> bool JsonTape::Value::is<Json::number_int>(void) const { return get_type() == Json::NUMBER_INT; }
+template<> bool JsonTape::Value::is<bool>(void) const { return get_type() == Json::BOOL; }
+
+template<> Json::string JsonTape::Value::get<Json::string>(void) const {
+	check_tag(Json::STRING);
+	return (string_ref().str());
+}
+
+template<> StringRef JsonTape::Value::get<StringRef>(void) const {
+	check_tag(Json::STRING);
+	return (string_ref());
+}
+
+template<> Json::number_float JsonTape::Value::get<Json::number_float>(void) const {
+	check_tag(Json::NUMBER_FLOAT);
+	Json::number_float	f;
+	std::memcpy(&f, &tape->tape[idx + 1], sizeof(f));
+	return (f);
+}
+
+template<> Json::number_int JsonTape::Value::get<Json::number_int>(void) const {
+	check_tag(Json::NUMBER_INT);
+	Json::number_int	i;
+	std::memcpy(&i, &tape->tape[idx + 1], sizeof(i));
+	return (i);
+}
+
+template<> bool JsonTape::Value::get<bool>(void) const {
+	check_tag(Json::BOOL);
+	return (word_tag(word()) == TAG_TRUE);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+	Handler that writes the events onto a tape. Containers are opened with a
+	placeholder that is filled in with their end and size when they close.
+*/
+class TapeBuilder
+{
+	public:
+		TapeBuilder(JsonTape& tape) : tape(tape) {}
+
+		bool on_null(void) { tape.push(JsonTape::TAG_NULL); return (true); }
+		bool on_bool(bool b) { tape.push(b ? JsonTape::TAG_TRUE : JsonTape::TAG_FALSE); return (true); }
+		bool on_int(Json::number_int i) { tape.push_int(i); return (true); }
+		bool on_double(Json::number_float f) { tape.push_float(f); return (true); }
+		bool on_string(StringRef str) { tape.push_string(str.data(), str.size()); return (true); }
+		bool on_key(StringRef key) { tape.push_string(key.data(), key.size()); return (true); }
+
+		bool on_object_start(void) { open.push_back(tape.open_container(JsonTape::TAG_OBJECT)); return (true); }
+		bool on_array_start(void) { open.push_back(tape.open_container(JsonTape::TAG_ARRAY)); return (true); }
+		bool on_object_end(size_t count) { return (close(JsonTape::TAG_OBJECT_END, count)); }
+		bool on_array_end(size_t count) { return (close(JsonTape::TAG_ARRAY_END, count)); }
+
+	private:
+		bool close(JsonTape::Tag end_tag, size_t count) {
+			tape.close_container(open.back(), end_tag, count);
+			open.pop_back();
+			return (true);
+		}
+
+		JsonTape&			tape;
+		std::vector<size_t>	open;
+};
+
+JsonTape	JsonParser::parse_tape(void) {
+	JsonTape	tape;
+	TapeBuilder	builder(tape);
+
+	if (!parse(builder)) {
+		tape.clear();
+	}
+	return (tape);
+}
+
+} // namespace njson
@@ -0,0 +1,95 @@
+#include "Unescape.h"
+
+namespace njson {
+
+static int	hex_value(char c) {
+	if (c >= '0' && c <= '9') return (c - '0');
+	if (c >= 'a' && c <= 'f') return (c - 'a' + 10);
+	if (c >= 'A' && c <= 'F') return (c - 'A' + 10);
+	return (-1);
+}
+
+bool	read_hex4(char const* p, char const* end, unsigned& out) {
+	if (end - p < 4) return (false);
+	out = 0;
+	for (int i = 0; i < 4; ++i) {
+		int v = hex_value(p[i]);
+		if (v < 0) return (false);
+		out = (out << 4) | unsigned(v);
+	}
+	return (true);
+}
+
+static void	append_utf8(std::string& str, unsigned cp) {
+	if (cp < 0x80) {
+		str += char(cp);
+	} else if (cp < 0x800) {
+		str += char(0xC0 | (cp >> 6));
+		str += char(0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		str += char(0xE0 | (cp >> 12));
+		str += char(0x80 | ((cp >> 6) & 0x3F));
+		str += char(0x80 | (cp & 0x3F));
+	} else {
+		str += char(0xF0 | (cp >> 18));
+		str += char(0x80 | ((cp >> 12) & 0x3F));
+		str += char(0x80 | ((cp >> 6) & 0x3F));
+		str += char(0x80 | (cp & 0x3F));
+	}
+}
+
+char const*	unescape_string(char const* p, char const* end, std::string& str) {
+	while (p < end) {
+		// copy runs without escapes in one go
+		char const*	run = p;
+		while (p < end && *p != '\"' && *p != '\\') {
+			++p;
+		}
+		str.append(run, p - run);
+		if (p == end || *p == '\"') {
+			return (p);
+		}
+
+		if (++p == end) {
+			break ;
+		}
+		char	c = *p++;
+		switch (c) {
+			case '\"' :
+			case '\\' :
+			case '/' : str += c; break ;
+			case 'b' : str += '\b'; break ;
+			case 'f' : str += '\f'; break ;
+			case 'n' : str += '\n'; break ;
+			case 'r' : str += '\r'; break ;
+			case 't' : str += '\t'; break ;
+			case 'u' : {
+				unsigned	cp;
+				if (!read_hex4(p, end, cp)) {
+					return (nullptr);
+				}
+				p += 4;
+				// a surrogate is only valid as a high surrogate followed by a low one
+				if (cp >= 0xDC00 && cp < 0xE000) {
+					return (nullptr);
+				}
+				if (cp >= 0xD800 && cp < 0xDC00) {
+					unsigned	low;
+					if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || !read_hex4(p + 2, end, low)
+						|| low < 0xDC00 || low >= 0xE000) {
+						return (nullptr);
+					}
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					p += 6;
+				}
+				append_utf8(str, cp);
+				break ;
+			}
+			default :
+				return (nullptr);
+		}
+	}
+	return (end);
+}
+
+} // namespace njson
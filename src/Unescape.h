@@ -0,0 +1,24 @@
+#ifndef NJSON_UNESCAPE_H
+# define NJSON_UNESCAPE_H
+
+# include <string>
+
+namespace njson {
+
+/*
+	Decoding of the contents of JSON strings. Shared by the parser and the
+	push parser, which decode while parsing (string views included), and
+	by on-demand documents, which decode the strings a lookup reaches.
+*/
+
+// reads 4 hex digits at p, false if they aren't there
+bool		read_hex4(char const* p, char const* end, unsigned& out);
+
+// appends the string contents starting at p to out, decoding escape sequences.
+// Stops at the closing quote (or end) and returns its position, or null on a bad escape:
+// anything but \" \\ \/ \b \f \n \r \t and \uXXXX, or a surrogate that isn't a high-low pair
+char const*	unescape_string(char const* p, char const* end, std::string& out);
+
+} // namespace njson
+
+#endif // NJSON_UNESCAPE_H
@@ -0,0 +1,248 @@
+#include "njson/writer.h"
+#include "njson/number.h"
+
+namespace njson {
+
+/* -------------------------------------------------------------------------- */
+/*                                Construction                                */
+/* -------------------------------------------------------------------------- */
+
+JsonWriter::JsonWriter(bool pretty)
+	: flush_size(0)
+	, pretty(pretty) {}
+
+// nothing is reserved, a small print only allocates what it writes and the buffer stops growing around flush_size
+JsonWriter::JsonWriter(sink_t sink, bool pretty, size_t flush_size)
+	: sink(std::move(sink))
+	, flush_size(flush_size)
+	, pretty(pretty) {}
+
+JsonWriter::JsonWriter(std::ostream& out, bool pretty, size_t flush_size)
+	: JsonWriter([&out](char const* data, size_t size) { out.write(data, size); }, pretty, flush_size) {}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Output                                   */
+/* -------------------------------------------------------------------------- */
+
+void JsonWriter::flush(void) {
+	if (!sink || buffer.empty())
+		return ;
+	sink(buffer.data(), buffer.size());
+	buffer.clear();
+}
+
+std::string JsonWriter::release(void) {
+	std::string	out;
+	out.swap(buffer);
+	return (out);
+}
+
+void JsonWriter::write(Json const& json) {
+	write_tree(json, 0);
+	flush_if_full();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Values                                   */
+/* -------------------------------------------------------------------------- */
+
+// without recursion, the containers above the one being written wait on the stack
+void JsonWriter::write_tree(Json const& json, size_t depth) {
+	size_t	base = open.size();
+	write_value(json, depth);
+	while (open.size() > base) {
+		OpenValue&	container = open.back();
+		size_t		level = container.depth;
+		if (container.json->type == Json::ARRAY) {
+			Json::array const&	arr = container.json->value.as_array;
+			if (container.next > 0) {
+				end_element(container.next == arr.size());
+				flush_if_full();
+			}
+			if (container.next == arr.size()) {
+				end_array(level);
+				open.pop_back();
+				continue ;
+			}
+			Json const&	element = arr[container.next++];
+			begin_element(level);
+			write_value(element, level + 1);
+		} else {
+			Json::object const&	obj = container.json->value.as_object;
+			if (container.next > 0) {
+				end_member(container.next == obj.size());
+				flush_if_full();
+			}
+			if (container.next == obj.size()) {
+				end_object(level);
+				open.pop_back();
+				continue ;
+			}
+			auto const&	member = obj.begin()[container.next++];
+			begin_member(member.first, level);
+			write_value(member.second, level + 1);
+		}
+	}
+}
+
+void JsonWriter::write_value(Json const& json, size_t depth) {
+	switch (json.type) {
+		case Json::NUMBER_FLOAT : {
+			size_t	n = buffer.size();
+			buffer.resize(n + number_buffer_size);
+			char*	first = &buffer[n];
+			buffer.resize(n + (format_double(first, json.value.as_float) - first));
+			break;
+		}
+		case Json::NUMBER_INT : {
+			size_t	n = buffer.size();
+			buffer.resize(n + number_buffer_size);
+			char*	first = &buffer[n];
+			buffer.resize(n + (format_int(first, json.value.as_int) - first));
+			break;
+		}
+		case Json::BOOL :
+			if (json.value.as_bool)
+				buffer.append("true", 4);
+			else
+				buffer.append("false", 5);
+			break;
+		case Json::STRING : {
+			StringRef	str = json.get_string_ref();
+			append_string(buffer, str.data(), str.size());
+			break;
+		}
+		case Json::OBJECT :
+			if (begin_object(json.value.as_object.size()))
+				open.push_back(OpenValue{&json, 0, depth});
+			break;
+		case Json::ARRAY :
+			if (begin_array(json.value.as_array.size(), depth))
+				open.push_back(OpenValue{&json, 0, depth});
+			break;
+		case Json::NULL_T :
+			buffer.append("null", 4);
+			break;
+		default:
+			buffer.append("UNKNOWN_TYPE");
+	}
+}
+
+void JsonWriter::write_indent(size_t depth) {
+	std::string const&	indent = Json::get_indentation_string();
+	while (depth-- > 0)
+		buffer.append(indent);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Containers                                 */
+/* -------------------------------------------------------------------------- */
+
+bool JsonWriter::begin_object(size_t size) {
+	buffer.push_back('{');
+	if (size == 0) {
+		buffer.push_back('}');
+		return (false);
+	}
+	if (pretty)
+		buffer.push_back('\n');
+	return (true);
+}
+
+void JsonWriter::begin_member(Key const& key, size_t depth) {
+	if (pretty)
+		write_indent(depth + 1);
+	append_string(buffer, key.data(), key.size());
+	if (pretty)
+		buffer.append(": ", 2);
+	else
+		buffer.push_back(':');
+}
+
+void JsonWriter::end_member(bool last) {
+	if (!last)
+		buffer.push_back(',');
+	if (pretty)
+		buffer.push_back('\n');
+}
+
+void JsonWriter::end_object(size_t depth) {
+	if (pretty)
+		write_indent(depth);
+	buffer.push_back('}');
+}
+
+// an empty array still gets its line break when pretty
+bool JsonWriter::begin_array(size_t size, size_t depth) {
+	buffer.push_back('[');
+	if (size == 0) {
+		end_array(depth);
+		return (false);
+	}
+	return (true);
+}
+
+void JsonWriter::begin_element(size_t depth) {
+	if (pretty) {
+		buffer.push_back('\n');
+		write_indent(depth + 1);
+	}
+}
+
+void JsonWriter::end_element(bool last) {
+	if (last)
+		return ;
+	if (pretty)
+		buffer.append(", ", 2);
+	else
+		buffer.push_back(',');
+}
+
+void JsonWriter::end_array(size_t depth) {
+	if (pretty) {
+		buffer.push_back('\n');
+		write_indent(depth);
+	}
+	buffer.push_back(']');
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Strings                                  */
+/* -------------------------------------------------------------------------- */
+
+// 0: copied as is, otherwise the character after the backslash ('u' for \u00XX)
+static const char	escape_table[256] = {
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+void JsonWriter::append_string(std::string& out, char const* str, size_t len) {
+	static const char	hex[] = "0123456789abcdef";
+
+	out.push_back('"');
+	char const*	end = str + len;
+	char const*	run = str;
+	for (char const* p = str; p != end; ++p) {
+		unsigned char	c = static_cast<unsigned char>(*p);
+		char			esc = escape_table[c];
+		if (esc == 0)
+			continue ;
+
+		out.append(run, p - run);
+		run = p + 1;
+		out.push_back('\\');
+		out.push_back(esc);
+		if (esc == 'u') {
+			char	code[4] = {'0', '0', hex[c >> 4], hex[c & 0xF]};
+			out.append(code, 4);
+		}
+	}
+	out.append(run, end - run);
+	out.push_back('"');
+}
+
+} // namespace njson
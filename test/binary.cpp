@@ -0,0 +1,51 @@
+#include "njson/njson.h"
+#include "check.h"
+
+#include <string>
+
+using namespace njson;
+
+static Json::pointer_t	parse(std::string const& text, size_t max_depth = 1024) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_max_depth(max_depth);
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	return (json);
+}
+
+static Json::pointer_t	load(std::string const& snapshot, size_t max_depth, std::string* errmsg = nullptr) {
+	JsonParser	parser(snapshot.data(), snapshot.size());
+	parser.set_max_depth(max_depth);
+	Json::pointer_t	json = parser.load_binary();
+	if (errmsg != nullptr)
+		*errmsg = parser.get_error_msg();
+	return (json);
+}
+
+// every type, keys shared between objects, empty containers
+static void	round_trip(void) {
+	std::string		text = "{\"a\":[null,true,false,-1,9223372036854775807,-0.5,1e300,\"s\\\"\\u00e9\"],"
+		"\"b\":{\"a\":{},\"c\":[]},\"c\":[{\"a\":1},{\"a\":2,\"b\":3}]}";
+	Json::pointer_t	json = parse(text);
+	std::string		snapshot = json->to_binary();
+	CHECK_EQ(load(snapshot, 1024)->to_string(false), json->to_string(false));
+}
+
+// deeper than the parser's default limit: written without recursion, loaded with the same limit as parsing
+static void	deep_tree(void) {
+	size_t const	depth = 3000;
+	std::string		text = std::string(depth, '[') + "{\"k\":1}" + std::string(depth, ']');
+	Json::pointer_t	json = parse(text, depth + 1);
+	std::string		snapshot = json->to_binary();
+
+	CHECK_EQ(load(snapshot, depth + 1)->to_string(false), text);
+	std::string	errmsg;
+	load(snapshot, depth, &errmsg);
+	CHECK_EQ(errmsg, "document too deep, nested more than " + std::to_string(depth) + " levels");
+}
+
+int	main(void) {
+	round_trip();
+	deep_tree();
+	return (njson_test::check_result());
+}
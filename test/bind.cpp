@@ -0,0 +1,125 @@
+#include "njson/njson.h"
+#include "njson/bind.h"
+#include "check.h"
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace njson;
+
+struct Inner { std::string name; std::vector<int> values; };
+struct Record {
+	bool							flag;
+	int8_t							small;
+	int64_t							big;
+	uint8_t							byte;
+	uint64_t						count;
+	float							ratio;
+	double							scale;
+	std::string						text;
+	std::vector<Inner>				inners;
+	std::map<std::string, uint64_t>	totals;
+};
+
+NJSON_BIND(Inner, name, values)
+NJSON_BIND(Record, flag, small, big, byte, count, ratio, scale, text, inners, totals)
+
+static bool	read(std::string const& text, Record& record, std::string* errmsg = nullptr) {
+	JsonParser	parser(text.data(), text.size());
+	bool		ok = parser.parse_into(record);
+	if (errmsg != nullptr)
+		*errmsg = parser.get_error_msg();
+	return (ok);
+}
+
+static std::string	error(std::string const& text) {
+	Record		record = Record();
+	std::string	errmsg;
+	CHECK(!read(text, record, &errmsg));
+	return (errmsg);
+}
+
+// the extremes of every member type are written and read back unchanged
+static void	round_trip(void) {
+	Record	record;
+	record.flag = true;
+	record.small = std::numeric_limits<int8_t>::min();
+	record.big = std::numeric_limits<int64_t>::min();
+	record.byte = std::numeric_limits<uint8_t>::max();
+	record.count = std::numeric_limits<uint64_t>::max();
+	record.ratio = 0.1f;
+	record.scale = 0.1;
+	record.text = "q\"\\\n\xc3\xa9";
+	record.inners = {Inner{"a", {1, -2}}, Inner{"", {}}};
+	record.totals = {{"x", uint64_t(1) << 63}, {"y", 0}};
+
+	std::string	json = to_json(record);
+	CHECK(json.find("\"count\":18446744073709551615") != std::string::npos);
+	CHECK(json.find("\"ratio\":0.1,") != std::string::npos);
+
+	Record	back = Record();
+	CHECK(read(json, back));
+	CHECK_EQ(to_json(back), json);
+	CHECK_EQ(back.count, record.count);
+	CHECK_EQ(back.totals["x"], uint64_t(1) << 63);
+	CHECK(back.ratio == record.ratio);
+	CHECK_EQ(back.text, record.text);
+
+	// floats that need all their digits
+	for (float f : {3.4028235e38f, 1.17549435e-38f, 1e-45f, 16777217.0f, 0.3f, 1.0f / 3}) {
+		Record	one = Record();
+		one.ratio = f;
+		Record	copy = Record();
+		CHECK(read(to_json(one), copy));
+		CHECK(copy.ratio == f);
+	}
+}
+
+// the first value of a key wins, like in the tree parse() builds
+static void	duplicates(void) {
+	std::string	text = "{\"big\":1,\"text\":\"first\",\"big\":2,\"totals\":{\"k\":3,\"k\":4},\"text\":\"second\"}";
+	Record		record = Record();
+	CHECK(read(text, record));
+	CHECK_EQ(record.big, int64_t(1));
+	CHECK_EQ(record.text, std::string("first"));
+	CHECK_EQ(record.totals["k"], uint64_t(3));
+
+	JsonParser		parser(text.data(), text.size());
+	Json::pointer_t	json = parser.parse();
+	CHECK_EQ(json->find("big").get<Json::number_int>(), record.big);
+	CHECK_EQ(json->find("text").get<Json::string>(), record.text);
+	CHECK_EQ(json->find("totals").find("k").get<Json::number_int>(), int64_t(record.totals["k"]));
+
+	// a duplicate is still parsed, an invalid one is an error
+	CHECK(!error("{\"big\":1,\"big\":[}").empty());
+}
+
+static void	errors(void) {
+	CHECK_EQ(error("{\"small\":128}"), std::string("small: integer out of range: 128"));
+	CHECK_EQ(error("{\"byte\":-1}"), std::string("byte: integer out of range: -1"));
+	CHECK_EQ(error("{\"count\":-1}"), std::string("count: integer out of range: -1"));
+	CHECK_EQ(error("{\"count\":18446744073709551616}"), std::string("count: integer out of range: 18446744073709551616"));
+	CHECK_EQ(error("{\"count\":1e3}"), std::string("count: expected an integer"));
+	CHECK_EQ(error("{\"count\":-9223372036854775809}"), std::string("count: expected an integer"));
+	CHECK_EQ(error("{\"big\":1.5}"), std::string("big: expected an integer"));
+	CHECK_EQ(error("{\"ratio\":\"x\"}"), std::string("ratio: expected a number"));
+	CHECK_EQ(error("{\"inners\":[{\"values\":[1,true]}]}"), std::string("inners: values: expected an integer"));
+	CHECK_EQ(error("{\"text\":\"a\\x\"}"), std::string("text: bad escape sequence in string"));
+	CHECK_EQ(error("{\"flag\":true} 1"), std::string("unexpected data after the document"));
+
+	// null and unknown keys keep the member
+	Record	record = Record();
+	record.big = 7;
+	CHECK(read("{\"big\":null,\"unknown\":{\"a\":[1]}}", record));
+	CHECK_EQ(record.big, int64_t(7));
+}
+
+int	main(void) {
+	round_trip();
+	duplicates();
+	errors();
+	return (njson_test::check_result());
+}
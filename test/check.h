@@ -0,0 +1,44 @@
+#ifndef NJSON_TEST_CHECK_H
+# define NJSON_TEST_CHECK_H
+
+# include <cstdlib>
+# include <iostream>
+
+/*
+	Minimal checks for the unit tests: a failed CHECK prints where it
+	failed and the test continues, the exit status of main() (through
+	check_result()) tells ctest whether anything failed.
+*/
+namespace njson_test {
+
+inline int&	failures(void) {
+	static int	count = 0;
+	return (count);
+}
+
+inline int	check_result(void) {
+	if (failures() != 0)
+		std::cerr << failures() << " check(s) failed" << std::endl;
+	return (failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+} // namespace njson_test
+
+# define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl; \
+			++njson_test::failures(); \
+		} \
+	} while (0)
+
+# define CHECK_EQ(a, b) \
+	do { \
+		if (!((a) == (b))) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " \
+				<< (a) << " != " << (b) << std::endl; \
+			++njson_test::failures(); \
+		} \
+	} while (0)
+
+#endif // NJSON_TEST_CHECK_H
@@ -0,0 +1,80 @@
+#include "njson/njson.h"
+#include "njson/on_demand.h"
+#include "njson/tape.h"
+#include "check.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace njson;
+
+// every escape JSON has, and a surrogate pair (U+1F600)
+static char const	all_escapes[] = "\"q\\\"b\\\\s\\/e\\b\\f\\n\\r\\t\\u00e9\\ud83d\\ude00\"";
+static char const	all_decoded[] = "q\"b\\s/e\b\f\n\r\t\xc3\xa9\xf0\x9f\x98\x80";
+
+static char const*	bad_strings[] = {
+	"\"a\\x\"", "\"\\'\"", "\"\\0\"", "\"\\U0041\"", "\"\\u12\"", "\"\\uZZZZ\"",
+	// unpaired surrogates
+	"\"\\ud800\"", "\"\\udc00\"", "\"\\ud800x\"", "\"\\ud800\\u0041\"", "\"\\udbff\\ud800\"", "\"\\ude00\\ud83d\"",
+};
+
+// the string as a value and as a key, with the options that change how strings are read
+static void	dom(std::string const& text, bool valid) {
+	std::string const	padding(600, ' ');	// large enough for the structural index
+	std::string const	inputs[] = {text, "{" + text + ":1}", "[" + text + "]" + padding};
+
+	for (std::string const& input : inputs) {
+		for (int views = 0; views < 2; ++views) {
+			JsonParser	parser(input.data(), input.size());
+			parser.set_use_string_views(views != 0);
+			parser.parse();
+			CHECK_EQ(parser.has_error(), !valid);
+			if (!valid)
+				CHECK_EQ(parser.get_error_msg(), std::string("bad escape sequence in string"));
+		}
+
+		JsonParser	tape_parser(input.data(), input.size());
+		tape_parser.parse_tape();
+		CHECK_EQ(tape_parser.has_error(), !valid);
+
+		for (size_t chunk : {1, 3, 1000}) {
+			JsonParser	parser;
+			for (size_t pos = 0; pos < input.size() && parser.feed(input.data() + pos, std::min(chunk, input.size() - pos)); pos += chunk)
+				;
+			parser.finish();
+			CHECK_EQ(parser.has_error(), !valid);
+			if (!valid)
+				CHECK_EQ(parser.get_error_msg(), std::string("bad escape sequence in string"));
+		}
+	}
+}
+
+// on demand, strings are decoded when a lookup reads them
+static void	on_demand(std::string const& text, bool valid) {
+	std::string	value = "{\"k\":" + text + "}";
+	JsonParser	value_parser(value.data(), value.size());
+	JsonOnDemand	value_doc = value_parser.parse_on_demand();
+	value_doc.root().find("k").get<Json::string>();
+	CHECK_EQ(value_doc.has_error(), !valid);
+
+	std::string	key = "{" + text + ":1}";
+	JsonParser	key_parser(key.data(), key.size());
+	JsonOnDemand	key_doc = key_parser.parse_on_demand();
+	key_doc.root().find("other");
+	CHECK_EQ(key_doc.has_error(), !valid);
+}
+
+int	main(void) {
+	JsonParser		parser(all_escapes, sizeof(all_escapes) - 1);
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	CHECK_EQ(json->get<Json::string>(), std::string(all_decoded));
+
+	dom(all_escapes, true);
+	on_demand(all_escapes, true);
+	for (char const* text : bad_strings) {
+		dom(text, false);
+		on_demand(text, false);
+	}
+	return (njson_test::check_result());
+}
@@ -0,0 +1,122 @@
+#include "njson/njson.h"
+#include "njson/key.h"
+#include "check.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace njson;
+
+// every key of the schema is found in its slot, or not at all when the hash couldn't place it
+static size_t	check_schema(KeySchema const& schema, std::vector<std::string> const& keys) {
+	size_t	found = 0;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		size_t	slot = schema.find(keys[i]);
+		if (slot == KeySchema::npos)
+			continue ;
+		CHECK_EQ(schema.key(slot).str(), keys[i]);
+		++found;
+	}
+	return (found);
+}
+
+static void	lookup(void) {
+	std::vector<std::string>	keys = {"timestamp", "device_id", "cpu_load", "id", "", "x", "a_much_longer_key_than_16_bytes"};
+	KeySchema					schema(keys);
+	CHECK_EQ(schema.size(), keys.size());
+	for (size_t i = 0; i < keys.size(); ++i) {
+		CHECK_EQ(schema.find(keys[i]), i);
+		CHECK_EQ(schema.key(i).str(), keys[i]);
+	}
+
+	// unknown keys, also ones that share a prefix, a suffix or the length with a key of the schema
+	for (char const* unknown : {"timestam", "timestampX", "Timestamp", "device_ie", "cpu", "i", "xx", "y",
+			"a_much_longer_key_than_16_byteZ", "a_much_longer_key_than_16_bytes!", "idle"})
+		CHECK_EQ(schema.find(unknown), KeySchema::npos);
+
+	// duplicates are registered once, in the slot of their first occurrence
+	KeySchema	twice{"a", "b", "a", "c", "b"};
+	CHECK_EQ(twice.size(), size_t(3));
+	CHECK_EQ(twice.find("a"), size_t(0));
+	CHECK_EQ(twice.find("b"), size_t(1));
+	CHECK_EQ(twice.find("c"), size_t(2));
+
+	KeySchema	empty{};
+	CHECK_EQ(empty.size(), size_t(0));
+	CHECK_EQ(empty.find("a"), KeySchema::npos);
+	CHECK_EQ(empty.find(""), KeySchema::npos);
+}
+
+// keys that the sampled fingerprint can't tell apart (same length, first and last 8 bytes)
+static void	collisions(void) {
+	std::vector<std::string>	keys;
+	for (char c = 'a'; c <= 'z'; ++c)
+		keys.push_back(std::string("prefix__") + c + "_middle_" + c + "_suffix__");
+	keys.push_back("prefix__short");
+	KeySchema	schema(keys);
+	CHECK_EQ(check_schema(schema, keys), keys.size());
+	CHECK_EQ(schema.find("prefix__A_middle_a_suffix__"), KeySchema::npos);
+	CHECK_EQ(schema.find("prefix__a_middle_b_suffix__"), KeySchema::npos);
+
+	// a set of hundreds may leave keys out, but never finds a wrong slot
+	std::vector<std::string>	many;
+	for (size_t i = 0; i < 500; ++i)
+		many.push_back("field_" + std::to_string(i * 7919));
+	KeySchema	large(many);
+	CHECK(check_schema(large, many) > many.size() / 2);
+	for (size_t i = 0; i < 500; ++i)
+		CHECK_EQ(large.find("field_" + std::to_string(i * 7919 + 1)), KeySchema::npos);
+}
+
+static Json::pointer_t	parse(std::string const& text, std::shared_ptr<KeySchema const> const& schema, size_t threads = 1) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_key_schema(schema);
+	parser.set_threads(threads);
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	return (json);
+}
+
+static void	documents(void) {
+	std::shared_ptr<KeySchema const>	schema = std::make_shared<KeySchema const>(
+		std::vector<std::string>{"id", "name", "tags"});
+
+	// schema keys are the schema's own, unknown keys are interned as usual
+	Json::pointer_t	json = parse("{\"id\":1,\"other\":2,\"name\":\"n\",\"tags\":{\"id\":3,\"other\":4}}", schema);
+	Json::object&	object = json->get<Json::object>();
+	CHECK_EQ(object.size(), size_t(4));
+	CHECK(object.begin()[0].first.data() == schema->key(0).data());
+	CHECK(object.begin()[2].first.data() == schema->key(1).data());
+	CHECK(object.begin()[1].first.is_interned());
+	CHECK(json->find("tags").get<Json::object>().begin()[1].first.data() == object.begin()[1].first.data());
+	CHECK_EQ(json->find("tags", "id").get<Json::number_int>(), Json::number_int(3));
+	CHECK_EQ(json->to_string(false), std::string("{\"id\":1,\"other\":2,\"name\":\"n\",\"tags\":{\"id\":3,\"other\":4}}"));
+
+	// the first of two equal keys is kept, for schema keys and unknown keys, in every object
+	Json::pointer_t	dup = parse("[{\"id\":1,\"x\":1,\"id\":2,\"x\":2},{\"id\":3,\"id\":4},{\"name\":{\"name\":5,\"name\":6}}]", schema);
+	CHECK_EQ(dup->to_string(false), std::string("[{\"id\":1,\"x\":1},{\"id\":3},{\"name\":{\"name\":5}}]"));
+
+	// the same as without the schema
+	std::string		text = "{\"tags\":[{\"id\":1,\"name\":\"a\",\"id\":9},{}],\"id\":null,\"z\":{\"tags\":[],\"y\":0}}";
+	CHECK_EQ(parse(text, schema)->to_string(false), parse(text, nullptr)->to_string(false));
+
+	// a parallel parse shares the schema between its threads
+	std::string	records = "[";
+	for (size_t i = 0; i < 100000; ++i)
+		records += std::string(i == 0 ? "" : ",") + "{\"id\":" + std::to_string(i) + ",\"extra\":0,\"id\":-1}";
+	records += "]";
+	Json::pointer_t		parallel = parse(records, schema, 4);
+	Json::array const&	elements = parallel->get<Json::array>();
+	CHECK_EQ(elements.size(), size_t(100000));
+	CHECK_EQ(elements.back().get<Json::object>().size(), size_t(2));
+	CHECK_EQ(elements.back().find("id").get<Json::number_int>(), Json::number_int(99999));
+	CHECK(elements.back().get<Json::object>().begin()->first.data() == schema->key(0).data());
+}
+
+int	main(void) {
+	lookup();
+	collisions();
+	documents();
+	return (njson_test::check_result());
+}
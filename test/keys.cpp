@@ -0,0 +1,122 @@
+#include "njson/njson.h"
+#include "njson/key.h"
+#include "check.h"
+
+#include <string>
+#include <vector>
+
+using namespace njson;
+
+static Json::pointer_t	parse(std::string const& text, bool intern, size_t threads = 1) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_intern_keys(intern);
+	parser.set_threads(threads);
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	return (json);
+}
+
+static Key const&	key_of(Json const& object, size_t i) {
+	return (object.get<Json::object>().begin()[i].first);
+}
+
+static std::string	records(size_t count) {
+	std::string	text = "[";
+	for (size_t i = 0; i < count; ++i)
+		text += std::string(i == 0 ? "" : ",") + "{\"id\":" + std::to_string(i) + ",\"name\":\"r\",\"tags\":[]}";
+	return (text + "]");
+}
+
+// equal keys of a document share one copy, different ones don't
+static void	shared_keys(void) {
+	Json::pointer_t	doc = parse(records(3), true);
+	Json const&		first = doc->get<Json::array>()[0];
+	for (Json const& record : doc->get<Json::array>()) {
+		for (size_t i = 0; i < 3; ++i) {
+			CHECK(key_of(record, i).is_interned());
+			CHECK(key_of(record, i).data() == key_of(first, i).data());
+		}
+	}
+	CHECK(key_of(first, 0).data() != key_of(first, 1).data());
+	CHECK(key_of(first, 0) != key_of(first, 1));
+
+	// interned keys still equal keys from elsewhere, and find() uses them
+	CHECK(key_of(first, 0) == Key("id"));
+	CHECK(Key("name") == key_of(first, 1));
+	CHECK_EQ(doc->get<Json::array>()[2].find("id").get<Json::number_int>(), Json::number_int(2));
+
+	// without interning every occurrence is its own copy
+	Json::pointer_t	plain = parse(records(2), false);
+	Json const&		a = plain->get<Json::array>()[0];
+	Json const&		b = plain->get<Json::array>()[1];
+	CHECK(!key_of(a, 0).is_interned());
+	CHECK(key_of(a, 0).data() != key_of(b, 0).data());
+	CHECK(key_of(a, 0) == key_of(b, 0));
+	CHECK(key_of(a, 0) == key_of(first, 0));
+}
+
+// keys of two documents have different pools and compare by their characters
+static void	across_documents(void) {
+	Json::pointer_t	one = parse("{\"k\":1,\"other\":2}", true);
+	Json::pointer_t	two = parse("{\"k\":3}", true);
+	CHECK(key_of(*one, 0).data() != key_of(*two, 0).data());
+	CHECK(key_of(*one, 0) == key_of(*two, 0));
+	CHECK(key_of(*one, 1) != key_of(*two, 0));
+
+	// a parallel parse interns per chunk, equal keys of different chunks are still equal
+	Json::pointer_t	parallel = parse(records(200000), true, 4);
+	Json::array const&	elements = parallel->get<Json::array>();
+	CHECK_EQ(elements.size(), size_t(200000));
+	CHECK(key_of(elements.front(), 0) == key_of(elements.back(), 0));
+	CHECK_EQ(elements.back().find("id").get<Json::number_int>(), Json::number_int(199999));
+}
+
+// a key keeps the storage of its document alive
+static void	key_lifetime(void) {
+	Key	kept;
+	{
+		Json::pointer_t	doc = parse("{\"survives\":1}", true);
+		kept = key_of(*doc, 0);
+	}
+	CHECK(kept.is_interned());
+	CHECK_EQ(kept.str(), std::string("survives"));
+}
+
+static void	pool(void) {
+	KeyPool				keys;
+	std::vector<Key>	first;
+	for (size_t i = 0; i < 1000; ++i) {
+		std::string	str = "key" + std::to_string(i);
+		first.push_back(keys.intern(str.data(), str.size()));
+	}
+	CHECK_EQ(keys.size(), size_t(1000));
+
+	// the table grew on the way, the same keys are still found
+	for (size_t i = 0; i < 1000; ++i) {
+		std::string	str = "key" + std::to_string(i);
+		Key			again = keys.intern(str.data(), str.size());
+		CHECK(again.data() == first[i].data());
+		CHECK_EQ(again.str(), str);
+	}
+	CHECK_EQ(keys.size(), size_t(1000));
+
+	Key	empty = keys.intern("", 0);
+	CHECK(empty.empty() && empty.is_interned());
+	CHECK(keys.intern("", 0).data() == empty.data());
+
+	// after a reset the pool starts over, keys handed out stay valid
+	keys.reset(nullptr);
+	CHECK_EQ(keys.size(), size_t(0));
+	Key	fresh = keys.intern("key0", 4);
+	CHECK(fresh.data() != first[0].data());
+	CHECK(fresh == first[0]);
+	CHECK_EQ(first[999].str(), std::string("key999"));
+}
+
+int	main(void) {
+	shared_keys();
+	across_documents();
+	key_lifetime();
+	pool();
+	return (njson_test::check_result());
+}
@@ -0,0 +1,208 @@
+#include "njson/njson.h"
+#include "check.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace njson;
+
+static Json::pointer_t	parse(char const* text) {
+	JsonParser	parser(text, std::strlen(text));
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	return (json);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Move assignment                              */
+/* -------------------------------------------------------------------------- */
+
+// the child is part of the value it's assigned to
+static void	assign_own_child(void) {
+	Json::pointer_t	doc = parse("{\"data\":{\"x\":[1,2,{\"y\":\"z\"}]},\"other\":true}");
+	*doc = std::move(doc->find("data"));
+	CHECK_EQ(doc->to_string(false), std::string("{\"x\":[1,2,{\"y\":\"z\"}]}"));
+
+	*doc = std::move(doc->find("x").get<Json::array>()[2]);
+	CHECK_EQ(doc->to_string(false), std::string("{\"y\":\"z\"}"));
+
+	Json	heap(Json::array{});
+	heap.add_to_array(Json("a"));
+	heap.add_to_array(Json(Json::array{}));
+	heap.get<Json::array>()[1].add_to_array(Json(1));
+	heap = std::move(heap.get<Json::array>()[1]);
+	CHECK_EQ(heap.to_string(false), std::string("[1]"));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Allocators                                 */
+/* -------------------------------------------------------------------------- */
+
+// a heap container assigned the container of a document keeps the heap, the document can go
+static void	assign_document_container(void) {
+	Json	array(Json::array{});
+	Json	object(Json::object{});
+	{
+		Json::pointer_t	doc = parse("{\"data\":{\"x\":[1,\"two\",{\"three\":3}],\"y\":{\"a\":[true]}}}");
+		array.get<Json::array>() = std::move(doc->find("data", "x").get<Json::array>());
+		object.get<Json::object>() = std::move(doc->find("data", "y").get<Json::object>());
+	}
+	CHECK_EQ(array.to_string(false), std::string("[1,\"two\",{\"three\":3}]"));
+	CHECK_EQ(object.to_string(false), std::string("{\"a\":[true]}"));
+	CHECK(array.get<Json::array>().get_allocator().get_arena() == nullptr);
+	CHECK(object.get<Json::object>().get_allocator().get_arena() == nullptr);
+
+	// and the other way around, heap values moved into a document
+	Json::pointer_t	doc = parse("{\"x\":[0],\"y\":{}}");
+	doc->find("x").get<Json::array>() = std::move(array.get<Json::array>());
+	doc->find("y").get<Json::object>() = std::move(object.get<Json::object>());
+	array = Json();
+	object = Json();
+	CHECK_EQ(doc->to_string(false), std::string("{\"x\":[1,\"two\",{\"three\":3}],\"y\":{\"a\":[true]}}"));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Subtrees                                  */
+/* -------------------------------------------------------------------------- */
+
+// a subtree moved out of a document keeps the arena of the document alive
+static void	move_out_subtree(void) {
+	Json	servers;
+	Json	name;
+	{
+		Json::pointer_t	doc = parse("{\"servers\":[{\"host\":\"a\\\"b\",\"ports\":[80,443]},{\"host\":\"c\"}],"
+			"\"name\":\"a name that is too long for any small string buffer\"}");
+		servers = std::move(doc->find("servers"));
+		name = std::move(doc->find("name"));
+		CHECK(doc->find("servers").is<Json::null_t>());
+		CHECK_EQ(doc->to_string(false), std::string("{\"servers\":null,\"name\":null}"));
+	}
+	CHECK_EQ(servers.to_string(false), std::string("[{\"host\":\"a\\\"b\",\"ports\":[80,443]},{\"host\":\"c\"}]"));
+	CHECK_EQ(name.get<Json::string>(), std::string("a name that is too long for any small string buffer"));
+
+	// still usable as a tree: it grows on the heap, next to what's in the arena
+	servers.add_to_array(Json(Json::object{}));
+	servers.get<Json::array>()[2].add_to_object("host", Json("d"));
+	servers.get<Json::array>()[0].find("ports").add_to_array(Json(8080));
+	Json	first = std::move(servers.get<Json::array>()[0]);
+	servers = Json();
+	CHECK_EQ(first.to_string(false), std::string("{\"host\":\"a\\\"b\",\"ports\":[80,443,8080]}"));
+}
+
+// a whole document moved into a value, and out again
+static void	move_document(void) {
+	Json	root;
+	{
+		Json::pointer_t	doc = parse("{\"a\":{\"b\":[1,2,3]}}");
+		root = std::move(*doc);
+	}
+	CHECK_EQ(root.to_string(false), std::string("{\"a\":{\"b\":[1,2,3]}}"));
+	Json	b(std::move(root.find("a", "b")));
+	root = Json();
+	CHECK_EQ(b.to_string(false), std::string("[1,2,3]"));
+}
+
+// string views point into the input, which the document keeps alive
+static void	string_views(void) {
+	Json	strings;
+	{
+		std::istringstream	in("{\"plain\":[\"one\",\"two\"],\"escaped\":\"tab\\there\"}");
+		JsonParser			parser(in);
+		parser.set_use_string_views(true);
+		Json::pointer_t		doc = parser.parse();
+		CHECK(!parser.has_error());
+		strings = std::move(*doc);
+	}
+	// a const node is only read: escaped strings were decoded while parsing, views stay views
+	Json const&	escaped = strings.find("escaped");
+	Json const&	one = strings.find("plain").get<Json::array>()[0];
+	CHECK(escaped.get_string_ref() == StringRef("tab\there"));
+	bool	threw = false;
+	try {
+		one.get<Json::string>();
+	} catch (Json::json_exception const&) {
+		threw = true;
+	}
+	CHECK(threw);
+	CHECK_EQ(one.get_string(), std::string("one"));
+	CHECK_EQ(escaped.get_string(), std::string("tab\there"));
+
+	CHECK_EQ(strings.find("plain").get<Json::array>()[1].get<Json::string>(), std::string("two"));
+	CHECK_EQ(strings.find("escaped").get<Json::string>(), std::string("tab\there"));
+
+	Json	plain = std::move(strings.find("plain"));
+	strings = Json();
+	CHECK_EQ(plain.to_string(false), std::string("[\"one\",\"two\"]"));
+}
+
+// a clone doesn't share anything with the document
+static void	clone_independence(void) {
+	Json::pointer_t	doc = parse("{\"list\":[1,{\"k\":\"v\"}],\"s\":\"text\"}");
+	Json			copy = doc->clone();
+	Json			list = doc->find("list").clone();
+
+	doc->find("list").add_to_array(Json(2));
+	doc->find("list").get<Json::array>()[1].find("k") = Json("changed");
+	CHECK_EQ(copy.to_string(false), std::string("{\"list\":[1,{\"k\":\"v\"}],\"s\":\"text\"}"));
+
+	doc.reset();
+	CHECK(copy.find("list").get<Json::array>().get_allocator().get_arena() == nullptr);
+	copy.find("s") = Json("other");
+	CHECK_EQ(copy.to_string(false), std::string("{\"list\":[1,{\"k\":\"v\"}],\"s\":\"other\"}"));
+	CHECK_EQ(list.to_string(false), std::string("[1,{\"k\":\"v\"}]"));
+}
+
+// a lookup that finds nothing gives a null node that nothing else sees
+static void	missing_keys(void) {
+	Json::pointer_t	doc = parse("{\"a\":{\"b\":1}}");
+	Json const&		const_doc = *doc;
+	CHECK(&const_doc.find("x") == &Json::null_ref());
+	CHECK(&const_doc.find("a", "x") == &Json::null_ref());
+	CHECK_EQ(const_doc.find("a", "b").get<Json::number_int>(), int64_t(1));
+
+	doc->find("x") = Json("written");
+	CHECK(doc->find("x").is<Json::null_t>());
+	CHECK(doc->find("a", "b", "c").is<Json::null_t>());
+	CHECK(Json::null_ref().is<Json::null_t>());
+
+	Json*	other = nullptr;
+	std::thread	thread([&]() { other = &Json::missing_ref(); });
+	thread.join();
+	CHECK(other != &Json::missing_ref());
+}
+
+// containers of one document grow from two threads, their arena is shared by then
+static void	grow_from_threads(void) {
+	Json::pointer_t	doc = parse("{\"a\":[],\"b\":[]}");
+	auto			append = [&](char const* key) {
+		for (int i = 0; i < 20000; ++i) {
+			Json	pair(Json::array{});
+			pair.add_to_array(Json(i));
+			pair.add_to_array(Json(std::to_string(i)));
+			doc->find(key).add_to_array(std::move(pair));
+		}
+	};
+	std::thread		a(append, "a");
+	std::thread		b(append, "b");
+	a.join();
+	b.join();
+	for (char const* key : {"a", "b"}) {
+		Json::array const&	array = doc->find(key).get<Json::array>();
+		CHECK_EQ(array.size(), size_t(20000));
+		CHECK_EQ(array.back().to_string(false), std::string("[19999,\"19999\"]"));
+	}
+}
+
+int	main(void) {
+	assign_own_child();
+	assign_document_container();
+	move_out_subtree();
+	move_document();
+	string_views();
+	clone_independence();
+	missing_keys();
+	grow_from_threads();
+	return (njson_test::check_result());
+}
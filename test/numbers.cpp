@@ -0,0 +1,240 @@
+#include "njson/number.h"
+#include "check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace njson;
+
+static uint64_t	bits(double f) {
+	uint64_t	b;
+	std::memcpy(&b, &f, sizeof(b));
+	return (b);
+}
+
+// parse_number() of the whole text, false if it fails or stops early
+static bool	parse(std::string const& text, int64_t& i, double& f, bool& is_float) {
+	char const*	p = text.data();
+	return (parse_number(p, text.data() + text.size(), i, f, is_float) && p == text.data() + text.size());
+}
+
+// a float that has to be exactly what strtod() reads
+static void	check_float(std::string const& text) {
+	int64_t	i;
+	double	f;
+	bool	is_float;
+	if (!parse(text, i, f, is_float) || !is_float) {
+		std::cerr << "not parsed as a float: " << text << std::endl;
+		CHECK(false);
+		return ;
+	}
+	if (bits(f) != bits(std::strtod(text.c_str(), nullptr))) {
+		std::cerr << "different from strtod: " << text << std::endl;
+		CHECK(false);
+	}
+}
+
+static void	check_int(std::string const& text, int64_t expected) {
+	int64_t	i;
+	double	f;
+	bool	is_float;
+	CHECK(parse(text, i, f, is_float) && !is_float && i == expected);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+static void	boundaries(void) {
+	check_int("0", 0);
+	check_int("-0", 0);
+	check_int("9223372036854775807", INT64_MAX);
+	check_int("-9223372036854775808", INT64_MIN);
+
+	char const*	floats[] = {
+		// integers that don't fit are promoted
+		"9223372036854775808", "-9223372036854775809", "18446744073709551616",
+		"123456789012345678901234567890",
+		"0.0", "-0.0", "1e0", "1E+2", "1e-0", "0.1", "0.3", "100.5e-3",
+		// subnormals, the smallest normal and the largest double
+		"4.9406564584124654e-324", "5e-324", "2.4703282292062328e-324", "2.4703282292062327e-324",
+		"2.2250738585072009e-308", "2.2250738585072011e-308", "2.2250738585072014e-308",
+		"1.7976931348623157e308", "1.7976931348623158e308",
+		// underflow to zero
+		"1e-400", "-1e-400", "0.0000000000000000000000000000001e-330",
+		// ties at 2^53, rounded to even
+		"9007199254740993.0", "9007199254740995.0", "9007199254740993.0000000000000001",
+		// more digits than fit in 64 bits, the tail decides the rounding
+		"0.1000000000000000055511151231257827021181583404541015625",
+		"0.1000000000000000055511151231257827021181583404541015624",
+		"2.22507385850720113605740979670913197593481954635164564e-308",
+		"7.2057594037927933e16", "3.0517578125e-05", "1.448997445238699", "4.35679E-01",
+	};
+	for (char const* text : floats)
+		check_float(text);
+
+	char const*	invalid[] = {
+		"", "-", "+1", "01", "-01", "1.", ".1", "1.e5", "1e", "1e+", "--1", "0x1", "1e309", "-1e309",
+		"1.7976931348623159e308", "nan", "inf",
+	};
+	for (char const* text : invalid) {
+		int64_t	i;
+		double	f;
+		bool	is_float;
+		if (parse(text, i, f, is_float)) {
+			std::cerr << "accepted: " << text << std::endl;
+			CHECK(false);
+		}
+	}
+}
+
+// random digits around every exponent, and the 17 digits of random doubles
+static void	random_round_trips(std::mt19937_64& random) {
+	char	buf[64];
+
+	for (int n = 0; n < 200000; ++n) {
+		std::string	text = (random() & 1) ? "-" : "";
+		size_t		digits = 1 + random() % 25;
+		size_t		dot = 1 + random() % (digits + 1);	// none when past the digits
+		text += char('1' + random() % 9);
+		for (size_t d = 1; d < digits; ++d) {
+			if (d == dot)
+				text += '.';
+			text += char('0' + random() % 10);
+		}
+		std::snprintf(buf, sizeof(buf), "e%d", int(random() % 660) - 345);
+		text += buf;
+		if (std::isfinite(std::strtod(text.c_str(), nullptr)))
+			check_float(text);
+	}
+
+	for (int n = 0; n < 200000; ++n) {
+		uint64_t	b = random();
+		double		f;
+		std::memcpy(&f, &b, sizeof(f));
+		if (!std::isfinite(f))
+			continue ;
+		std::snprintf(buf, sizeof(buf), "%.17g", f);
+		std::string	text(buf);
+		if (text.find_first_of(".e") == std::string::npos)
+			text += ".0";
+		check_float(text);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Formatting                                 */
+/* -------------------------------------------------------------------------- */
+
+static std::string	format(double f) {
+	char	buf[number_buffer_size];
+	return (std::string(buf, format_double(buf, f)));
+}
+
+static void	formatting(void) {
+	CHECK_EQ(format(0.0), std::string("0.0"));
+	CHECK_EQ(format(-0.0), std::string("-0.0"));
+	CHECK_EQ(format(1.0), std::string("1.0"));
+	CHECK_EQ(format(0.1), std::string("0.1"));
+	CHECK_EQ(format(100.0), std::string("100.0"));
+	CHECK_EQ(format(1e21), std::string("1e21"));
+	CHECK_EQ(format(1e-7), std::string("1e-7"));
+	CHECK_EQ(format(5e-324), std::string("5e-324"));
+	CHECK_EQ(format(1.7976931348623157e308), std::string("1.7976931348623157e308"));
+	CHECK_EQ(format(std::nan("")), std::string("null"));
+	CHECK_EQ(format(HUGE_VAL), std::string("null"));
+	CHECK_EQ(format(-HUGE_VAL), std::string("null"));
+}
+
+// the output reads back as the same double, as a float, and fits the buffer
+static void	check_format(double f) {
+	std::string	text = format(f);
+	int64_t		i;
+	double		back;
+	bool		is_float;
+	if (!parse(text, i, back, is_float) || !is_float || bits(back) != bits(f)) {
+		std::cerr << "format_double() doesn't round-trip: " << text << std::endl;
+		CHECK(false);
+	}
+	CHECK(int(text.size()) < number_buffer_size);
+	CHECK_EQ(bits(std::strtod(text.c_str(), nullptr)), bits(f));
+}
+
+static void	random_formatting(std::mt19937_64& random) {
+	double const	edges[] = {
+		5e-324, 1e-323, 2.2250738585072009e-308, 2.2250738585072014e-308, 1.7976931348623157e308,
+		9007199254740992.0, 9007199254740994.0, 0.30000000000000004, 1e23, 123456789.0,
+	};
+	for (double f : edges) {
+		check_format(f);
+		check_format(-f);
+	}
+
+	for (int n = 0; n < 200000; ++n) {
+		uint64_t	b = random();
+		double		f;
+		std::memcpy(&f, &b, sizeof(f));
+		if (std::isfinite(f))
+			check_format(f);
+	}
+	// short decimals, which have a short shortest representation
+	for (int n = 0; n < 100000; ++n)
+		check_format(double(random() % 1000000) / std::pow(10.0, double(random() % 12)));
+}
+
+static std::string	format_f(float f) {
+	char	buf[number_buffer_size];
+	return (std::string(buf, format_float(buf, f)));
+}
+
+// the digits of the float read back through a double, like a float member does, and aren't longer than the double's
+static void	check_format_f(float f) {
+	std::string	text = format_f(f);
+	int64_t		i;
+	double		back;
+	bool		is_float;
+	if (!parse(text, i, back, is_float) || !is_float || float(back) != f) {
+		std::cerr << "format_float() doesn't round-trip: " << text << std::endl;
+		CHECK(false);
+	}
+	CHECK(text.size() <= format(double(f)).size());
+}
+
+static void	float_formatting(std::mt19937_64& random) {
+	CHECK_EQ(format_f(0.1f), std::string("0.1"));
+	CHECK_EQ(format_f(-0.0f), std::string("-0.0"));
+	CHECK_EQ(format_f(16777216.0f), std::string("16777216.0"));
+	CHECK_EQ(format_f(3.4028235e38f), std::string("3.4028235e38"));
+	CHECK_EQ(format_f(1e-45f), std::string("1e-45"));
+
+	// the shortest digits of 7.038531e-26f round to the next float through a double
+	float const	edges[] = {1e-45f, 1.17549435e-38f, 3.4028235e38f, 16777217.0f, 7.038531e-26f};
+	for (float f : edges) {
+		check_format_f(f);
+		check_format_f(-f);
+	}
+
+	for (int n = 0; n < 200000; ++n) {
+		uint32_t	b = uint32_t(random());
+		float		f;
+		std::memcpy(&f, &b, sizeof(f));
+		if (std::isfinite(f))
+			check_format_f(f);
+	}
+}
+
+int	main(void) {
+	std::mt19937_64	random(20240611);
+
+	boundaries();
+	random_round_trips(random);
+	formatting();
+	random_formatting(random);
+	float_formatting(random);
+	return (njson_test::check_result());
+}
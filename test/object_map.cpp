@@ -0,0 +1,148 @@
+#include "njson/njson.h"
+#include "njson/object_map.h"
+#include "check.h"
+
+#include <string>
+
+using namespace njson;
+
+typedef ObjectMap<int>	Map;
+
+static std::string	name(int i) {
+	return ("member" + std::to_string(i));
+}
+
+static void	fill(Map& map, int count) {
+	for (int i = 0; i < count; ++i)
+		CHECK(map.emplace(Key(name(i)), int(i)).second);
+}
+
+// every member is found, by key and by key and hash, and the order is the insertion order
+static void	check_members(Map const& map, int first, int count) {
+	CHECK_EQ(map.size(), size_t(count));
+	for (int i = 0; i < count; ++i) {
+		std::string	key = name(first + i);
+		CHECK(map.find(key) != map.end() && map.find(key)->second == first + i);
+		CHECK(map.find(key, Key::hash(key.data(), key.size())) == map.find(key));
+		CHECK_EQ(map.begin()[i].first.str(), key);
+	}
+	CHECK(map.find("absent") == map.end());
+	CHECK_EQ(map.count("absent"), size_t(0));
+}
+
+// below and above the size that builds the hash index
+static void	lookup(void) {
+	for (int count : {1, int(Map::index_threshold), int(Map::index_threshold) + 1, 100, 5000}) {
+		Map	map;
+		fill(map, count);
+		check_members(map, 0, count);
+
+		// an existing key keeps its member
+		std::pair<Map::iterator, bool>	existing = map.emplace(Key(name(count - 1)), -1);
+		CHECK(!existing.second);
+		CHECK_EQ(existing.first->second, count - 1);
+		CHECK_EQ(map.size(), size_t(count));
+	}
+
+	// appending a key twice keeps both, find() returns the first
+	Map	map;
+	fill(map, 40);
+	map.append(Key(name(3)), 99);
+	CHECK_EQ(map.size(), size_t(41));
+	CHECK_EQ(map.find(name(3))->second, 3);
+}
+
+static void	erase(void) {
+	Map	map;
+	fill(map, 40);
+
+	// the front, the middle, the back and a missing key
+	CHECK_EQ(map.erase(name(0)), size_t(1));
+	CHECK_EQ(map.erase(name(20)), size_t(1));
+	CHECK_EQ(map.erase(name(39)), size_t(1));
+	CHECK_EQ(map.erase("absent"), size_t(0));
+	CHECK_EQ(map.size(), size_t(37));
+	CHECK(map.find(name(0)) == map.end() && map.find(name(20)) == map.end() && map.find(name(39)) == map.end());
+	for (int i = 1; i < 39; ++i) {
+		if (i != 20)
+			CHECK(map.find(name(i)) != map.end() && map.find(name(i))->second == i);
+	}
+	CHECK_EQ(map.begin()[19].first.str(), name(21));
+
+	// erasing by iterator returns the next member
+	Map::iterator	next = map.erase(map.find(name(1)));
+	CHECK_EQ(next->first.str(), name(2));
+
+	// down to a few members and back up again
+	while (map.size() > 5)
+		map.erase(map.begin());
+	check_members(map, 34, 5);
+	for (int i = 100; i < 130; ++i)
+		map.emplace(Key(name(i)), int(i));
+	CHECK_EQ(map.size(), size_t(35));
+	CHECK_EQ(map.find(name(129))->second, 129);
+	CHECK_EQ(map.find(name(38))->second, 38);
+
+	// after erasing the first of two equal keys the second is found
+	map.append(Key(name(38)), 7);
+	map.erase(name(38));
+	CHECK_EQ(map.find(name(38))->second, 7);
+
+	// clear() keeps the index, which is empty
+	map.clear();
+	CHECK(map.empty() && map.find(name(100)) == map.end());
+	fill(map, 30);
+	check_members(map, 0, 30);
+}
+
+// moving between maps of different allocators moves the members one by one and rebuilds the index
+static void	allocators(void) {
+	Arena*	arena = new Arena();
+	arena->retain();
+	{
+		Map	in_arena{Map::allocator_type(arena)};
+		fill(in_arena, 50);
+		check_members(in_arena, 0, 50);
+
+		Map	on_heap;
+		fill(on_heap, 3);
+		on_heap = std::move(in_arena);
+		CHECK(in_arena.empty());
+		CHECK(on_heap.get_allocator().get_arena() == nullptr);
+		check_members(on_heap, 0, 50);
+
+		Map	back{Map::allocator_type(arena)};
+		back = std::move(on_heap);
+		check_members(back, 0, 50);
+		CHECK(back.get_allocator().get_arena() == arena);
+	}
+	arena->release();
+}
+
+// objects of a parsed document with many members
+static void	documents(void) {
+	std::string	text = "{";
+	for (int i = 0; i < 200; ++i)
+		text += std::string(i == 0 ? "" : ",") + "\"" + name(i) + "\":" + std::to_string(i);
+	text += ",\"" + name(7) + "\":-1}";
+
+	JsonParser		parser(text.data(), text.size());
+	Json::pointer_t	json = parser.parse();
+	CHECK_EQ(json->get<Json::object>().size(), size_t(200));
+	for (int i = 0; i < 200; ++i)
+		CHECK_EQ(json->find(name(i)).get<Json::number_int>(), Json::number_int(i));
+	CHECK(json->find("absent").is<Json::null_t>());
+
+	json->get<Json::object>().erase(name(150));
+	CHECK(json->find(name(150)).is<Json::null_t>());
+	CHECK_EQ(json->find(name(199)).get<Json::number_int>(), Json::number_int(199));
+	CHECK_EQ(json->get<Json::object>().size(), size_t(199));
+}
+
+int	main(void) {
+	lookup();
+	erase();
+	allocators();
+	documents();
+	return (njson_test::check_result());
+}
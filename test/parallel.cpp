@@ -0,0 +1,91 @@
+#include "njson/njson.h"
+#include "check.h"
+
+#include <random>
+#include <string>
+
+using namespace njson;
+
+// a top-level array of mixed records, a few MB so it's split into many ranges
+static std::string	make_array(size_t count) {
+	std::mt19937_64	random(42);
+	std::string		text = "[\n";
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i != 0)
+			text += ",\n";
+		switch (random() % 6) {
+			case 0 :
+				text += "{\"id\": " + std::to_string(i) + ", \"name\": \"user " + std::to_string(random() % 1000)
+					+ "\", \"tags\": [\"a\", \"b\\\"c\", \"\\u00e9t\\u00e9\"], \"score\": "
+					+ std::to_string(double(random() % 100000) / 100) + "}";
+				break ;
+			case 1 :
+				text += "[" + std::to_string(int64_t(random()) >> 1) + ", -0.5e-3, true, null, [], {}]";
+				break ;
+			case 2 :
+				text += "\"a string with, commas ] and } brackets " + std::to_string(i) + "\"";
+				break ;
+			case 3 :
+				text += "{\"nested\": {\"deeper\": {\"deepest\": [1, [2, [3, {\"k\": \"v\"}]]]}}}";
+				break ;
+			case 4 :
+				text += std::to_string(random() % 1000000);
+				break ;
+			default :
+				text += "{\"id\": " + std::to_string(i) + ", \"name\": \"line\\nbreak\\ttab\\\\\", \"ok\": false}";
+		}
+	}
+	text += "\n]\n";
+	return (text);
+}
+
+struct Result {
+	bool		error;
+	std::string	errmsg;
+	std::string	output;
+};
+
+static Result	parse(std::string const& text, size_t threads, bool arena, bool views, bool intern, size_t depth = 1024) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_threads(threads);
+	parser.set_use_arena(arena);
+	parser.set_use_string_views(views);
+	parser.set_intern_keys(intern);
+	parser.set_max_depth(depth);
+	Json::pointer_t	json = parser.parse();
+	return (Result{parser.has_error(), parser.get_error_msg(), json->to_string(false)});
+}
+
+// the same document, error or error message as the sequential parse
+static void	compare(std::string const& text, bool arena, bool views, bool intern, size_t depth = 1024) {
+	Result	expected = parse(text, 1, arena, views, intern, depth);
+	Result	result = parse(text, 4, arena, views, intern, depth);
+	CHECK_EQ(result.error, expected.error);
+	CHECK_EQ(result.errmsg, expected.errmsg);
+	CHECK(result.output == expected.output);
+}
+
+int	main(void) {
+	std::string	text = make_array(40000);
+	CHECK(text.size() > (size_t(1) << 21));
+	CHECK(!parse(text, 1, true, false, true).error);
+
+	compare(text, true, false, true);
+	compare(text, true, true, true);
+	compare(text, true, false, false);
+	compare(text, false, false, false);
+	// the deepest element is 7 levels down
+	compare(text, true, false, true, 7);
+
+	// an invalid element somewhere in the middle
+	std::string	invalid = text;
+	invalid.insert(invalid.size() / 2, "{\"broken\": [1, 2,]},\n");
+	compare(invalid, true, false, true);
+	CHECK(parse(invalid, 4, true, false, true).error);
+
+	std::string	unclosed = text.substr(0, text.rfind(']'));
+	compare(unclosed, true, false, true);
+	CHECK(parse(unclosed, 4, true, false, true).error);
+	return (njson_test::check_result());
+}
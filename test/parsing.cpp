@@ -0,0 +1,139 @@
+#include "njson/njson.h"
+#include "njson/bind.h"
+#include "njson/json_lines.h"
+#include "njson/on_demand.h"
+#include "njson/tape.h"
+#include "check.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace njson;
+
+struct Point { int x; int y; };
+NJSON_BIND(Point, x, y)
+
+static char const*	valid[] = {
+	"", "  \n", "{}", " [1, 2] \n", "1", "-2.5e3 ", "\"s\"\t", "true", "null\r\n", "{\"a\":[{}]}",
+};
+
+static char const*	trailing[] = {
+	"{\"a\":1} {\"b\":2}", "[1,2]]", "1 2", "\"a\"x", "{}}", "null,", "[] []", "{\"a\":1}\n#",
+};
+
+static bool	parses(std::string const& text, bool use_index, size_t threads = 1) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_use_index(use_index);
+	parser.set_threads(threads);
+	parser.parse();
+	return (!parser.has_error());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Parsing                                  */
+/* -------------------------------------------------------------------------- */
+
+static void	document_end(void) {
+	for (char const* text : valid) {
+		CHECK(parses(text, false));
+		CHECK(parses(text, true));
+	}
+	for (char const* text : trailing) {
+		CHECK(!parses(text, false));
+		CHECK(!parses(text, true));
+	}
+
+	JsonParser	parser("[1] 2", 5);
+	CHECK(parser.parse()->is<Json::null_t>());
+	CHECK_EQ(parser.get_error_msg(), std::string("unexpected data after the document"));
+
+	// large enough for the structural index, then for the parallel parse
+	for (size_t count : {100, 200000}) {
+		std::string	text = "[";
+		for (size_t i = 0; i < count; ++i)
+			text += (i == 0) ? "{\"n\":1}" : ",{\"n\":1}";
+		text += "]";
+		CHECK(parses(text + "\n ", true, 1));
+		CHECK(parses(text + "\n ", true, 4));
+		CHECK(!parses(text + " 1", true, 1));
+		CHECK(!parses(text + "]", true, 4));
+		CHECK(!parses(text + " {}", false));
+	}
+}
+
+// the other entry points follow the same rule
+static void	entry_points(void) {
+	for (char const* text : trailing) {
+		std::string	str(text);
+
+		JsonParser	tape_parser(str.data(), str.size());
+		CHECK(tape_parser.parse_tape().empty());
+		CHECK(tape_parser.has_error());
+
+		JsonParser	doc_parser(str.data(), str.size());
+		JsonOnDemand	doc = doc_parser.parse_on_demand();
+		doc.root().size();
+		CHECK(doc.has_error());
+	}
+
+	Point		point;
+	char const	bound[] = "{\"x\":1,\"y\":2}";
+	JsonParser	bind_parser(bound, sizeof(bound) - 1);
+	CHECK(bind_parser.parse_into(point));
+	CHECK_EQ(point.y, 2);
+	char const	bound_trailing[] = "{\"x\":1,\"y\":2},";
+	JsonParser	bind_trailing(bound_trailing, sizeof(bound_trailing) - 1);
+	CHECK(!bind_trailing.parse_into(point));
+
+	JsonParser	source("{\"a\":[1,\"b\"]}", 13);
+	std::ostringstream	out;
+	source.parse()->save_binary(out);
+	std::string	snapshot = out.str();
+	JsonParser	snapshot_parser(snapshot.data(), snapshot.size());
+	CHECK_EQ(snapshot_parser.load_binary()->to_string(false), std::string("{\"a\":[1,\"b\"]}"));
+	snapshot += '\0';
+	JsonParser	snapshot_trailing(snapshot.data(), snapshot.size());
+	snapshot_trailing.load_binary();
+	CHECK(snapshot_trailing.has_error());
+}
+
+// a line with two documents is one invalid record
+static void	json_lines(void) {
+	char const		text[] = "{\"a\":1} {\"b\":2}\n[1,2]]\n[3]\n";
+	JsonLinesReader	reader(text, sizeof(text) - 1);
+	reader.set_threads(1);
+
+	std::vector<std::string>	errors;
+	std::vector<bool>			valid_records;
+	reader.read([&](JsonLinesReader::Record& record) {
+		errors.push_back(record.error);
+		valid_records.push_back(!record.json->is<Json::null_t>());
+		return (true);
+	});
+	CHECK_EQ(errors.size(), size_t(3));
+	if (errors.size() == 3) {
+		CHECK_EQ(errors[0], std::string("unexpected data after the document"));
+		CHECK(!valid_records[0]);
+		CHECK(!errors[1].empty());
+		CHECK(errors[2].empty() && valid_records[2]);
+	}
+}
+
+// the stream is read once, parsing it again gives null like an empty input
+static void	exhausted_stream(void) {
+	std::istringstream	in("[1,2]\n");
+	JsonParser			parser(in);
+	CHECK_EQ(parser.parse()->to_string(false), std::string("[1,2]"));
+	CHECK(parser.parse()->is<Json::null_t>());
+	CHECK(parser.parse()->is<Json::null_t>());
+	CHECK(!parser.has_error());
+}
+
+int	main(void) {
+	document_end();
+	entry_points();
+	json_lines();
+	exhausted_stream();
+	return (njson_test::check_result());
+}
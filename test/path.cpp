@@ -0,0 +1,133 @@
+#include "njson/njson.h"
+#include "njson/path.h"
+#include "check.h"
+
+#include <string>
+
+using namespace njson;
+
+// the examples of RFC 6901, section 5, and a few more
+static char const*	document = "{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,\"i\\\\j\":5,"
+	"\"k\\\"l\":6,\" \":7,\"m~n\":8,\"~1\":9,\"~0/\":10,\"-\":11,\"01\":12,"
+	"\"list\":[{\"x\":[10,20]},null,{\"\":{\"\":\"empty\"}}]}";
+
+static Json::pointer_t	parse(std::string const& text) {
+	JsonParser	parser(text.data(), text.size());
+	return (parser.parse());
+}
+
+static Json::number_int	int_at(Json::pointer_t& json, char const* pointer) {
+	Json&	found = JsonPath(pointer).find(json);
+	CHECK(found.is<Json::number_int>());
+	return (found.is<Json::number_int>() ? found.get<Json::number_int>() : -1);
+}
+
+static bool	missing(Json::pointer_t& json, char const* pointer) {
+	return (JsonPath(pointer).find(json).is<Json::null_t>());
+}
+
+static bool	throws(char const* pointer) {
+	try {
+		JsonPath	path(pointer);
+	} catch (Json::json_exception const&) {
+		return (true);
+	}
+	return (false);
+}
+
+static void	escapes(void) {
+	Json::pointer_t	json = parse(document);
+	CHECK_EQ(int_at(json, "/"), Json::number_int(0));
+	CHECK_EQ(int_at(json, "/a~1b"), Json::number_int(1));
+	CHECK_EQ(int_at(json, "/c%d"), Json::number_int(2));
+	CHECK_EQ(int_at(json, "/e^f"), Json::number_int(3));
+	CHECK_EQ(int_at(json, "/g|h"), Json::number_int(4));
+	CHECK_EQ(int_at(json, "/i\\j"), Json::number_int(5));
+	CHECK_EQ(int_at(json, "/k\"l"), Json::number_int(6));
+	CHECK_EQ(int_at(json, "/ "), Json::number_int(7));
+	CHECK_EQ(int_at(json, "/m~0n"), Json::number_int(8));
+
+	// escapes are decoded left to right, "~01" is "~1" and not "~" followed by "/"
+	CHECK_EQ(int_at(json, "/~01"), Json::number_int(9));
+	CHECK_EQ(int_at(json, "/~00~1"), Json::number_int(10));
+	CHECK(missing(json, "/a/b"));
+
+	JsonPath	path("/~0~1x/~10");
+	CHECK_EQ(path.size(), size_t(2));
+	CHECK_EQ(path.key(0).str(), std::string("~/x"));
+	CHECK_EQ(path.key(1).str(), std::string("/0"));
+	CHECK_EQ(path.str(), std::string("/~0~1x/~10"));
+
+	// an escape has to be ~0 or ~1, and a pointer starts with '/'
+	CHECK(throws("/a~"));
+	CHECK(throws("/a~2"));
+	CHECK(throws("/~/x"));
+	CHECK(throws("/m~n"));
+	CHECK(throws("foo"));
+	CHECK(!throws(""));
+	CHECK(!throws("/"));
+}
+
+static void	indices(void) {
+	Json::pointer_t	json = parse(document);
+	CHECK_EQ(JsonPath("/foo/0").find(json).get<Json::string>(), std::string("bar"));
+	CHECK_EQ(JsonPath("/foo/1").find(json).get<Json::string>(), std::string("baz"));
+	CHECK(missing(json, "/foo/2"));
+	CHECK_EQ(int_at(json, "/list/0/x/1"), Json::number_int(20));
+	CHECK_EQ(JsonPath("/list/2//").find(json).get<Json::string>(), std::string("empty"));
+	CHECK(JsonPath("/list/1").find(json).is<Json::null_t>());
+
+	// leading zeros, signs and other characters aren't indices, but are keys
+	CHECK(missing(json, "/foo/01"));
+	CHECK(missing(json, "/foo/+1"));
+	CHECK(missing(json, "/foo/1x"));
+	CHECK(missing(json, "/foo/"));
+	CHECK(missing(json, "/foo/99999999999999999999"));
+	CHECK_EQ(int_at(json, "/01"), Json::number_int(12));
+	CHECK_EQ(JsonPath("/01").index(0), JsonPath::npos);
+	CHECK_EQ(JsonPath("/0").index(0), size_t(0));
+	CHECK_EQ(JsonPath("/123").index(0), size_t(123));
+
+	// "-" is the element after the last, which doesn't exist, but is a key on objects
+	CHECK(missing(json, "/foo/-"));
+	CHECK_EQ(JsonPath("/foo/-").index(1), JsonPath::npos);
+	CHECK_EQ(int_at(json, "/-"), Json::number_int(11));
+
+	// a segment past a scalar finds nothing
+	CHECK(missing(json, "/foo/0/x"));
+	CHECK(missing(json, "/-/0"));
+}
+
+static void	evaluation(void) {
+	Json::pointer_t	json = parse(document);
+
+	// the empty path is the whole document
+	JsonPath	root;
+	CHECK(root.empty());
+	CHECK(&root.find(json) == json.get());
+	CHECK(&JsonPath("").find(json) == json.get());
+
+	// the found node can be changed, and a path runs against any document
+	JsonPath	path("/list/0/x/0");
+	path.find(json) = Json(Json::number_int(11));
+	CHECK_EQ(int_at(json, "/list/0/x/0"), Json::number_int(11));
+	Json::pointer_t	other = parse("{\"list\":[{\"x\":[5]}]}");
+	CHECK_EQ(path.find(other).get<Json::number_int>(), Json::number_int(5));
+
+	// const documents
+	Json const&	constant = *json;
+	CHECK_EQ(path.find(constant).get<Json::number_int>(), Json::number_int(11));
+	CHECK(JsonPath("/nothing").find(constant).is<Json::null_t>());
+
+	// what isn't found is a fresh null node every time
+	Json&	none = JsonPath("/nothing").find(json);
+	none = Json(Json::number_int(1));
+	CHECK(missing(json, "/nothing"));
+}
+
+int	main(void) {
+	escapes();
+	indices();
+	evaluation();
+	return (njson_test::check_result());
+}
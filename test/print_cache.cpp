@@ -0,0 +1,141 @@
+#include "njson/njson.h"
+#include "njson/print_cache.h"
+#include "check.h"
+
+#include <sstream>
+#include <string>
+
+using namespace njson;
+
+static Json::pointer_t	parse(std::string const& text) {
+	JsonParser	parser(text.data(), text.size());
+	Json::pointer_t	json = parser.parse();
+	CHECK(!parser.has_error());
+	return (json);
+}
+
+static Json	record(size_t id) {
+	std::string	text = "{\"id\":" + std::to_string(id) + ",\"name\":\"record " + std::to_string(id)
+		+ "\",\"tags\":[\"a\",\"b\",{\"n\":" + std::to_string(id % 7) + "}]}";
+	return (std::move(*parse(text)));
+}
+
+static Json::pointer_t	document(void) {
+	Json::pointer_t	doc = parse("{\"config\":{},\"items\":[],\"small\":{\"a\":1},\"s\":\"x\"}");
+	Json&			config = doc->find("config");
+	for (size_t i = 0; i < 40; ++i)
+		config.add_to_object("k" + std::to_string(i), Json(Json::number_int(i)));
+	config.add_to_object("a/b~c", Json(true));
+	for (size_t i = 0; i < 200; ++i)
+		doc->find("items").add_to_array(record(i));
+	return (doc);
+}
+
+// what the cache prints after every change is what the tree prints
+static void	changes(bool pretty, size_t chunk_size) {
+	Json::pointer_t	doc = document();
+	JsonPrintCache	cache(*doc, pretty, chunk_size);
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	Json::array&	items = doc->find("items").get<Json::array>();
+	Json::object&	config = doc->find("config").get<Json::object>();
+
+	// appending to and erasing from the end of an array
+	doc->find("items").add_to_array(record(200));
+	cache.invalidate("/items/200");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	items.pop_back();
+	items.pop_back();
+	cache.invalidate("/items/200");
+	cache.invalidate("/items/199");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// inserting and erasing elsewhere invalidates the whole array
+	items.insert(items.begin() + 5, record(1000));
+	cache.invalidate("/items");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	items.erase(items.begin() + 3);
+	items.erase(items.begin());
+	cache.invalidate("/items");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// adding and erasing members of an object, found by their key
+	doc->find("config").add_to_object("added", Json("new"));
+	cache.invalidate("/config/added");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	config.erase("k5");
+	config.erase("k0");
+	cache.invalidate("/config/k5");
+	cache.invalidate("/config/k0");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	doc->find("small").add_to_object("b", Json(Json::number_int(2)));
+	doc->find("small").get<Json::object>().erase("a");
+	cache.invalidate("/small/b");
+	cache.invalidate("/small/a");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// replacing values: scalars, a container with a scalar and the other way around
+	doc->find("config", "k7") = Json("replaced");
+	cache.invalidate("/config/k7");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	items[0] = Json(Json::number_int(5));
+	cache.invalidate("/items/0");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	doc->find("s") = record(2000);
+	cache.invalidate("/s");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	doc->find("items") = Json(Json::array{});
+	cache.invalidate("/items");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	doc->find("items").add_to_array(record(1));
+	cache.invalidate("/items/0");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// values deep in the tree, and keys with escapes in their pointer
+	doc->find("s", "tags").get<Json::array>()[2].find("n") = Json(Json::number_float(0.5));
+	cache.invalidate("/s/tags/2/n");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+	doc->find("config", "a/b~c") = Json(false);
+	cache.invalidate("/config/a~1b~0c");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// pointers to nothing change nothing
+	cache.invalidate("/missing/0");
+	cache.invalidate("/items/7/x");
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+
+	// a new root value, then clear()
+	*doc = std::move(*parse("[1,{\"a\":[]}]"));
+	cache.clear();
+	CHECK_EQ(cache.str(), doc->to_string(pretty));
+}
+
+// changes that aren't reported stay invisible where the output is cached
+static void	cached_output(void) {
+	Json::pointer_t	doc = document();
+	JsonPrintCache	cache(*doc, false, 64);
+	std::string		before = cache.str();
+	doc->find("items").get<Json::array>()[50].find("id") = Json(Json::number_int(-1));
+	CHECK_EQ(cache.str(), before);
+	cache.invalidate("/items/50/id");
+	CHECK(cache.str() != before);
+	CHECK_EQ(cache.str(), doc->to_string(false));
+
+	// the root is invalidated with the empty pointer
+	doc->find("s") = Json("y");
+	cache.invalidate("");
+	CHECK_EQ(cache.str(), doc->to_string(false));
+
+	std::ostringstream	out;
+	cache.print(out);
+	CHECK_EQ(out.str(), doc->to_string(false) + "\n");
+}
+
+int	main(void) {
+	for (size_t chunk_size : {size_t(16), size_t(64), size_t(512), JsonPrintCache::default_chunk_size}) {
+		changes(false, chunk_size);
+		changes(true, chunk_size);
+	}
+	cached_output();
+	return (njson_test::check_result());
+}
@@ -0,0 +1,69 @@
+#include "njson/njson.h"
+#include "check.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace njson;
+
+static char const*	valid[] = {
+	"{}", " [1, 2] \n", "1", "-2.5e3 ", "\"s\"\t", "true", "null\r\n",
+	"{\"a\":[{}, [], \"x\\\"y\", -0.5, 12345678901234]}\n",
+	"[\"\\u00e9\\n\", {\"key\": {\"deep\": [true, false, null]}}]",
+};
+
+static char const*	trailing[] = {
+	"{\"a\":1} {\"b\":2}", "[1,2]]", "1 2", "\"a\"x", "{}}", "null,", "[] []", "{\"a\":1}\n#",
+};
+
+static char const*	invalid[] = {
+	"[1,]", "{\"a\" 1}", "[1 2]", "{\"a\":1", "[", "\"abc", "tru", "nul1", "{1:2}", "[01]",
+};
+
+struct Result {
+	bool		error;
+	std::string	errmsg;
+	std::string	output;
+};
+
+static Result	parse(std::string const& text) {
+	JsonParser		parser(text.data(), text.size());
+	Json::pointer_t	json = parser.parse();
+	return (Result{parser.has_error(), parser.get_error_msg(), json->to_string(false)});
+}
+
+// the same input fed in chunks of chunk bytes
+static Result	push(std::string const& text, size_t chunk) {
+	JsonParser	parser;
+	for (size_t pos = 0; pos < text.size() && parser.feed(text.data() + pos, std::min(chunk, text.size() - pos)); pos += chunk)
+		;
+	Json::pointer_t	json = parser.finish();
+	return (Result{parser.has_error(), parser.get_error_msg(), json->to_string(false)});
+}
+
+// both parsers take the same documents and reject the same inputs with the same error, whatever the chunks
+static void	compare(char const* text) {
+	Result	expected = parse(text);
+	for (size_t chunk : {1, 2, 3, 5, 8, 1000}) {
+		Result	result = push(text, chunk);
+		CHECK_EQ(result.error, expected.error);
+		CHECK_EQ(result.output, expected.output);
+		CHECK_EQ(result.errmsg, expected.errmsg);
+	}
+}
+
+int	main(void) {
+	for (char const* text : valid) {
+		CHECK(!parse(text).error);
+		compare(text);
+	}
+	for (char const* text : trailing) {
+		CHECK_EQ(parse(text).errmsg, std::string("unexpected data after the document"));
+		compare(text);
+	}
+	for (char const* text : invalid) {
+		CHECK(parse(text).error);
+		compare(text);
+	}
+	return (njson_test::check_result());
+}
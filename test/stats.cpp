@@ -0,0 +1,89 @@
+#include "njson/njson.h"
+#include "njson/stats.h"
+#include "check.h"
+
+#include <string>
+
+using namespace njson;
+
+// 2 objects, 2 arrays, 3 ints, 1 float, 2 strings, 2 bools, 1 null. keys and strings decode to 6 + 4 bytes
+static std::string const	document = "{\"ab\":[1,2.5,\"x\\n\"],\"c\":{\"d\":[true,false,null,-3]},\"e\":\"\\u00e9\",\"f\":4} ";
+
+static ParseStats	parse(std::string const& text, size_t threads = 1) {
+	JsonParser	parser(text.data(), text.size());
+	parser.set_threads(threads);
+	parser.parse();
+	CHECK(!parser.has_error());
+	return (parser.get_stats());
+}
+
+static void	check_zero(ParseStats const& stats) {
+	CHECK_EQ(stats.bytes, size_t(0));
+	CHECK_EQ(stats.node_count(), size_t(0));
+	CHECK_EQ(stats.max_depth, size_t(0));
+	CHECK_EQ(stats.string_bytes, size_t(0));
+	CHECK_EQ(stats.allocations, size_t(0));
+	CHECK_EQ(stats.allocated_bytes, size_t(0));
+	CHECK(stats.total_seconds == 0 && stats.tokenize_seconds == 0);
+	CHECK(stats.number_seconds == 0 && stats.build_seconds == 0);
+}
+
+static void	counters(void) {
+	ParseStats	stats = parse(document);
+	if (!ParseStats::enabled) {
+		check_zero(stats);
+		return ;
+	}
+	CHECK_EQ(stats.bytes, document.size());
+	CHECK_EQ(stats.nodes[Json::OBJECT], size_t(2));
+	CHECK_EQ(stats.nodes[Json::ARRAY], size_t(2));
+	CHECK_EQ(stats.nodes[Json::NUMBER_INT], size_t(3));
+	CHECK_EQ(stats.nodes[Json::NUMBER_FLOAT], size_t(1));
+	CHECK_EQ(stats.nodes[Json::STRING], size_t(2));
+	CHECK_EQ(stats.nodes[Json::BOOL], size_t(2));
+	CHECK_EQ(stats.nodes[Json::NULL_T], size_t(1));
+	CHECK_EQ(stats.node_count(), size_t(13));
+	CHECK_EQ(stats.max_depth, size_t(3));
+	CHECK_EQ(stats.string_bytes, size_t(10));
+	CHECK(stats.allocations > 0);
+	CHECK(stats.allocated_bytes > 0);
+	CHECK(stats.total_seconds > 0);
+	CHECK(stats.tokenize_seconds >= 0 && stats.number_seconds >= 0 && stats.build_seconds >= 0);
+
+	// every parse() starts over
+	ParseStats	scalar = parse("7");
+	CHECK_EQ(scalar.node_count(), size_t(1));
+	CHECK_EQ(scalar.nodes[Json::NUMBER_INT], size_t(1));
+	CHECK_EQ(scalar.max_depth, size_t(0));
+	CHECK_EQ(scalar.string_bytes, size_t(0));
+}
+
+// a parse on several threads counts the same values as one on a single thread
+static void	threads(void) {
+	std::string	text = "[";
+	for (size_t i = 0; i < 100000; ++i)
+		text += (i == 0) ? "{\"n\":[1,\"s\"]}" : ",{\"n\":[1,\"s\"]}";
+	text += "]";
+
+	ParseStats	one = parse(text, 1);
+	ParseStats	four = parse(text, 4);
+	if (!ParseStats::enabled) {
+		check_zero(one);
+		check_zero(four);
+		return ;
+	}
+	CHECK_EQ(one.node_count(), size_t(1 + 100000 * 4));
+	CHECK_EQ(four.bytes, one.bytes);
+	for (size_t type = 0; type < sizeof(one.nodes) / sizeof(*one.nodes); ++type)
+		CHECK_EQ(four.nodes[type], one.nodes[type]);
+	CHECK_EQ(four.max_depth, size_t(3));
+	CHECK_EQ(four.max_depth, one.max_depth);
+	CHECK_EQ(four.string_bytes, one.string_bytes);
+	CHECK(four.allocations > 0);
+}
+
+int	main(void) {
+	counters();
+	threads();
+	return (njson_test::check_result());
+}
@@ -0,0 +1,128 @@
+#include "njson/njson.h"
+#include "njson/tape.h"
+#include "check.h"
+
+#include <string>
+
+using namespace njson;
+
+static JsonTape	parse_tape(std::string const& text) {
+	JsonParser	parser(text.data(), text.size());
+	JsonTape	tape = parser.parse_tape();
+	CHECK(!parser.has_error());
+	return (tape);
+}
+
+static std::string	compact(std::string const& text) {
+	JsonParser	parser(text.data(), text.size());
+	return (parser.parse()->to_string(false));
+}
+
+static char const*	document = "{\"name\":\"n\\u00e9\\\"t\",\"port\":8080,\"ratio\":-2.5e-3,\"on\":true,\"off\":false,"
+	"\"none\":null,\"list\":[1,[2,{\"deep\":[3]}],{},[],\"x\"],\"empty\":{},\"last\":-9223372036854775808}";
+
+static void	values(void) {
+	JsonTape		tape = parse_tape(document);
+	JsonTape::Value	root = tape.root();
+	CHECK(root.is<Json::object>());
+	CHECK_EQ(root.size(), size_t(9));
+
+	CHECK_EQ(root.find("name").get<Json::string>(), std::string("n\xc3\xa9\"t"));
+	CHECK(root.find("name").get<StringRef>() == StringRef("n\xc3\xa9\"t"));
+	CHECK_EQ(root.find("port").get<Json::number_int>(), Json::number_int(8080));
+	CHECK(root.find("ratio").get<Json::number_float>() == -2.5e-3);
+	CHECK(root.find("on").get<bool>());
+	CHECK(!root.find("off").get<bool>());
+	CHECK(root.find("none").is<Json::null_t>());
+	CHECK_EQ(root.find("last").get<Json::number_int>(), Json::number_int(-9223372036854775807LL - 1));
+
+	// is<T>() for each type, get<T>() of another type throws
+	CHECK(root.find("port").is<Json::number_int>() && !root.find("port").is<Json::number_float>());
+	CHECK(root.find("ratio").is<Json::number_float>());
+	CHECK(root.find("name").is<Json::string>() && root.find("name").is<StringRef>());
+	CHECK(root.find("on").is<bool>() && root.find("list").is<Json::array>());
+	bool	thrown = false;
+	try {
+		root.find("name").get<Json::number_int>();
+	} catch (Json::json_exception const&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	// missing keys, out of range indices and lookups in scalars are null
+	CHECK(!root.find("missing"));
+	CHECK(!root.find("port", "x"));
+	CHECK(!root.find("list").at(5));
+	CHECK(!root.find("port").at(0));
+	CHECK_EQ(root.find("port").size(), size_t(0));
+}
+
+// the variadic find() and at() jump over the subtrees before them
+static void	navigation(void) {
+	JsonTape		tape = parse_tape(document);
+	JsonTape::Value	list = tape.root().find("list");
+	CHECK_EQ(list.size(), size_t(5));
+	CHECK_EQ(list.at(0).get<Json::number_int>(), Json::number_int(1));
+	CHECK_EQ(list.at(1).at(1).find("deep").at(0).get<Json::number_int>(), Json::number_int(3));
+	CHECK(list.at(2).is<Json::object>() && list.at(2).size() == 0);
+	CHECK(list.at(3).is<Json::array>() && list.at(3).size() == 0);
+	CHECK_EQ(list.at(4).get<Json::string>(), std::string("x"));
+	CHECK_EQ(tape.root().find("empty").size(), size_t(0));
+	CHECK_EQ(tape.root().find("last").get<Json::number_int>(), Json::number_int(-9223372036854775807LL - 1));
+
+	size_t	count = 0;
+	for (JsonTape::ArrayIterator it = list.begin_array(); it != list.end_array(); ++it)
+		++count;
+	CHECK_EQ(count, size_t(5));
+
+	std::string	keys;
+	JsonTape::Value	root = tape.root();
+	for (JsonTape::ObjectIterator it = root.begin_object(); it != root.end_object(); ++it)
+		keys += it.key().str() + ",";
+	CHECK_EQ(keys, std::string("name,port,ratio,on,off,none,list,empty,last,"));
+
+	// iterators of the wrong kind of container are empty
+	CHECK(list.begin_object() == list.end_object());
+	CHECK(root.begin_array() == root.end_array());
+}
+
+// to_json() builds the same tree as parse()
+static void	conversion(void) {
+	JsonTape	tape = parse_tape(document);
+	CHECK_EQ(tape.to_json()->to_string(false), compact(document));
+	CHECK_EQ(tape.root().find("list").to_json()->to_string(false), std::string("[1,[2,{\"deep\":[3]}],{},[],\"x\"]"));
+
+	for (char const* text : {"1", "\"s\"", "[]", "{}", "null", "[[[[]]]]", "{\"a\":1,\"a\":2}"}) {
+		JsonTape	one = parse_tape(text);
+		CHECK_EQ(one.to_json()->to_string(false), compact(text));
+	}
+
+	// an empty document gives an empty tape with a null root
+	JsonTape	empty = parse_tape("  ");
+	CHECK(empty.empty());
+	CHECK(empty.root().is<Json::null_t>());
+	CHECK(empty.to_json()->is<Json::null_t>());
+
+	tape.clear();
+	CHECK(tape.empty());
+}
+
+// a container with more elements than the tape word can count walks them for size()
+static void	saturated_count(void) {
+	JsonTape	tape;
+	size_t		start = tape.open_container(JsonTape::TAG_ARRAY);
+	tape.push_int(1);
+	tape.push(JsonTape::TAG_TRUE);
+	tape.push_string("s", 1);
+	tape.close_container(start, JsonTape::TAG_ARRAY_END, size_t(JsonTape::max_count) + 5);
+	CHECK_EQ(tape.root().size(), size_t(3));
+	CHECK_EQ(tape.to_json()->to_string(false), std::string("[1,true,\"s\"]"));
+}
+
+int	main(void) {
+	values();
+	navigation();
+	conversion();
+	saturated_count();
+	return (njson_test::check_result());
+}
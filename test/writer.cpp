@@ -0,0 +1,85 @@
+#include "njson/njson.h"
+#include "njson/print_cache.h"
+#include "njson/writer.h"
+#include "check.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace njson;
+
+// a small print doesn't allocate a flush-sized buffer
+static void	small_output(void) {
+	std::ostringstream	out;
+	JsonWriter			writer(out, false);
+	CHECK(writer.str().capacity() < 1024);
+
+	char const		text[] = "{\"a\":[1,2,3]}";
+	JsonParser		parser(text, sizeof(text) - 1);
+	writer.write(parser.parse());
+	CHECK(writer.str().capacity() < 1024);
+	writer.flush();
+	CHECK_EQ(out.str(), std::string(text));
+}
+
+// large output is handed over in chunks of about the flush size
+static void	chunked_output(void) {
+	Json	doc(Json::array{});
+	for (int i = 0; i < 10000; ++i)
+		doc.add_to_array(Json("element " + std::to_string(i)));
+
+	std::string			out;
+	std::vector<size_t>	chunks;
+	{
+		JsonWriter	writer([&](char const* data, size_t size) {
+			out.append(data, size);
+			chunks.push_back(size);
+		}, false, 4096);
+		writer.write(doc);
+		CHECK(writer.str().capacity() < 2 * 4096);
+	}
+	CHECK_EQ(out, doc.to_string(false));
+	CHECK(chunks.size() > 1);
+	for (size_t size : chunks)
+		CHECK(size < 4096 + 64);
+}
+
+// far deeper than the call stack allows per level: writing, caching and destroying don't recurse
+static void	deep_tree(void) {
+	size_t const	depth = 200000;
+	std::string		text = std::string(depth, '[') + "{\"k\":[]}" + std::string(depth, ']');
+	JsonParser		parser(text.data(), text.size());
+	parser.set_max_depth(depth + 2);
+	Json::pointer_t	doc = parser.parse();
+	CHECK(!parser.has_error());
+	CHECK_EQ(doc->to_string(false), text);
+
+	JsonPrintCache	cache(*doc, false, 64);
+	CHECK_EQ(cache.str(), text);
+	Json*	node = doc.get();
+	while (node->is<Json::array>())
+		node = &node->get<Json::array>()[0];
+	node->find("k").add_to_array(Json(1));
+
+	std::string	pointer;
+	for (size_t i = 0; i < depth; ++i)
+		pointer += "/0";
+	cache.invalidate(pointer + "/k");
+	std::string	changed = std::string(depth, '[') + "{\"k\":[1]}" + std::string(depth, ']');
+	CHECK_EQ(cache.str(), changed);
+	CHECK_EQ(doc->to_string(false), changed);
+
+	// pretty output of a shallower tree, every level indented
+	std::string	nested = "[[[{}]]]";
+	JsonParser	small(nested.data(), nested.size());
+	CHECK_EQ(small.parse()->to_string(true), std::string("[\n\t[\n\t\t[\n\t\t\t{}\n\t\t]\n\t]\n]"));
+	doc.reset();
+}
+
+int	main(void) {
+	small_output();
+	chunked_output();
+	deep_tree();
+	return (njson_test::check_result());
+}